@@ -3,22 +3,66 @@
 #include "OrderBookEntry.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
 
 class CSVReader
 {
     public:
+     /** how readCSV gets the file contents */
+     enum class ReadMode
+     {
+         /** std::getline + tokenise, one line at a time */
+         stream,
+         /** mmap the file and parse the fields in place */
+         mapped,
+         /** mapped, with the file split into chunks parsed on worker threads */
+         parallel
+     };
+
+     /** outcome of turning one row into an OrderBookEntry */
+     enum class ParseStatus
+     {
+         ok,
+         /** the row did not have exactly 5 fields */
+         badFieldCount,
+         /** price or amount is not a number */
+         badNumber,
+         /** the timestamp is not "YYYY/MM/DD HH:MM:SS[.ffffff]" */
+         badTimestamp
+     };
+
      CSVReader();
 
      static std::vector<OrderBookEntry> readCSV(std::string csvFile);
+     static std::vector<OrderBookEntry> readCSV(std::string csvFile, ReadMode mode);
+     /** mmap the file and build the entries straight from string_view fields,
+      * bad lines are skipped exactly like readCSV does */
+     static std::vector<OrderBookEntry> readCSVMapped(const std::string& csvFile);
+     /** split the mapped file at newline boundaries and parse the chunks on
+      * separate threads (0 = one per core), the result matches readCSV */
+     static std::vector<OrderBookEntry> readCSVParallel(const std::string& csvFile, unsigned int workers = 0);
      static std::vector<std::string> tokenise(std::string csvLine, char separator);
-    
-     static OrderBookEntry stringsToOBE(std::string price, 
-                                        std::string amount, 
-                                        std::string timestamp, 
-                                        std::string product, 
+     /** locale independent, non-throwing replacement for std::stod.
+      * accepts and rejects the same text as stod (leading spaces, a sign,
+      * trailing junk ignored) and returns false where stod would throw */
+     static bool parseDouble(std::string_view text, double& value);
+
+     static OrderBookEntry stringsToOBE(std::string price,
+                                        std::string amount,
+                                        std::string timestamp,
+                                        std::string product,
                                         OrderBookType OrderBookType);
 
     private:
-     static OrderBookEntry stringsToOBE(std::vector<std::string> strings);
-     
-};
\ No newline at end of file
+     /** build an entry from the fields of a row and append it, without throwing */
+     static ParseStatus fieldsToOBE(const std::string_view* fields, std::size_t count,
+                                    std::vector<OrderBookEntry>& entries);
+     /** parse every line of a block of text, appending the good ones */
+     static void parseLines(std::string_view text, std::vector<OrderBookEntry>& entries);
+     /** parse one line without allocating tokens, given the offsets of its
+      * separators (relative to base), returns false for a bad line */
+     static bool parseLine(std::string_view line, const std::uint32_t* seps, std::size_t sepCount,
+                           std::uint32_t base, std::vector<OrderBookEntry>& entries);
+
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/** Vectorised search for CSV delimiters.
+ * Compares 16 (SSE2) or 32 (AVX2) bytes per step and reports the offsets
+ * of every match. The instruction set is picked at runtime, see
+ * CpuFeatures, with a scalar loop everywhere else.
+ */
+class CSVScanner
+{
+    public:
+        /** append the offset of every separator and newline in data[0, size) */
+        static void findDelimiters(const char* data, std::size_t size, char separator,
+                                   std::vector<std::uint32_t>& offsets);
+        /** append the offset of every occurrence of c in data[0, size) */
+        static void findChar(const char* data, std::size_t size, char c,
+                             std::vector<std::uint32_t>& offsets);
+
+        /** walk the fields of one line with the same rules as CSVReader::tokenise:
+         * leading separators are skipped, an empty field ends the line and a
+         * trailing separator is ignored.
+         * seps are the separator offsets inside the line, shifted by base.
+         * f(std::string_view) is called per field and can return false to stop.
+         * returns the number of fields visited */
+        template <typename F>
+        static std::size_t forEachField(std::string_view line, const std::uint32_t* seps,
+                                        std::size_t count, std::uint32_t base, F&& f);
+};
+
+template <typename F>
+std::size_t CSVScanner::forEachField(std::string_view line, const std::uint32_t* seps,
+                                     std::size_t count, std::uint32_t base, F&& f)
+{
+    std::size_t fields = 0;
+    std::size_t k = 0;
+    std::size_t start = 0;
+    // skip leading separators
+    while (k < count && seps[k] - base == start)
+    {
+        ++start;
+        ++k;
+    }
+    while (start < line.size())
+    {
+        std::size_t end = k < count ? seps[k] - base : line.size();
+        if (start == end) break;
+        ++fields;
+        if (!f(line.substr(start, end - start))) break;
+        if (k >= count) break;
+        start = end + 1;
+        ++k;
+    }
+    return fields;
+}
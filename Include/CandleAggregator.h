@@ -0,0 +1,82 @@
+#pragma once
+
+#include "OrderBookEntry.h"
+#include "PriceStats.h"
+#include "SymbolTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/** one open-high-low-close-volume bar */
+struct Candle
+{
+    /** start of the interval, in ticks */
+    std::int64_t start;
+    double open;
+    double high;
+    double low;
+    double close;
+    double volume;
+    /** trades or quotes folded into the candle */
+    std::size_t events;
+};
+
+/** Streaming OHLCV candles per product over fixed time intervals.
+ * Every fill or quote is folded into its product's live candle in O(1).
+ * The live candle closes once an event lands in a later interval, and the
+ * next one opens at its close. Intervals without events get no candle.
+ */
+class CandleAggregator
+{
+    public:
+        /** candles interval ticks wide, starting at multiples of interval */
+        explicit CandleAggregator(std::int64_t interval);
+
+        /** fold a trade or quote into the candles of product.
+         * events come in time order per product, false for one older than
+         * the live candle */
+        bool add(SymbolId product, std::int64_t timestamp, double price, double amount);
+        /** fold a sale or an order, e.g. the sales of ReplayEngine::step */
+        bool add(const OrderBookEntry& entry);
+        /** fold the quotes of one tick at once: high and low come from stats
+         * and the close is their mean price. false if stats is empty */
+        bool add(SymbolId product, std::int64_t timestamp, const PriceStats& stats);
+        /** fold a candle of a finer interval, e.g. a closed 1 minute candle
+         * into the hour it belongs to. false if it is older than the live candle */
+        bool add(SymbolId product, const Candle& candle);
+
+        /** closed candles of product, oldest first */
+        const std::vector<Candle>& getClosed(SymbolId product) const;
+        /** the candle in progress, nullptr before the first event */
+        const Candle* getLive(SymbolId product) const;
+        /** closed candles followed by the live one */
+        std::vector<Candle> getCandles(SymbolId product) const;
+        /** changes whenever a candle of product does */
+        std::uint64_t getVersion(SymbolId product) const;
+
+        std::int64_t getInterval() const { return interval; }
+        /** keep only the latest capacity closed candles per product, 0 keeps
+         * them all. Old candles are dropped in batches, so up to twice as
+         * many can be held in between */
+        void setCapacity(std::size_t capacity);
+        /** forget every candle */
+        void clear();
+
+    private:
+        struct Series
+        {
+            std::vector<Candle> closed;
+            Candle live;
+            bool hasLive = false;
+            std::uint64_t version = 0;
+        };
+
+        /** the live candle for timestamp, closing the one before if the
+         * interval moved on. nullptr if timestamp is older than it */
+        Candle* liveCandle(Series& s, std::int64_t timestamp, double firstPrice);
+
+        std::int64_t interval;
+        std::size_t capacity;
+        std::unordered_map<SymbolId, Series> series;
+};
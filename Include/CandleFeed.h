@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CandlePyramid.h"
+#include "OrderBook.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+/** Candles of the quotes in an OrderBook as a replay moves through it.
+ * Each tick of each product becomes one PriceStats summary of its asks and
+ * bids, fed into a CandlePyramid. A tick is read once, when advance first
+ * passes it. Series handed out are cached per (product, level) and rebuilt
+ * only once the product has had new ticks.
+ */
+class CandleFeed
+{
+    public:
+        explicit CandleFeed(const OrderBook& book,
+                            std::vector<std::int64_t> intervals = CandlePyramid::defaultIntervals());
+
+        /** read the ticks up to timestamp that have not been read yet.
+         * Going back in time, e.g. after a rewind, starts the candles over */
+        void advance(std::int64_t timestamp);
+
+        /** the finest level that covers span with at most maxCandles candles,
+         * the coarsest one if none does */
+        std::size_t levelForSpan(std::int64_t span, std::size_t maxCandles) const;
+        /** candles of product at level, oldest first. The reference stays
+         * valid until the next call for the same product and level */
+        const std::vector<Candle>& getCandles(SymbolId product, std::size_t level);
+        /** changes whenever the candles of product do */
+        std::uint64_t getVersion(SymbolId product) const { return pyramid.getVersion(product); }
+        const CandlePyramid& getPyramid() const { return pyramid; }
+
+    private:
+        struct Cached
+        {
+            bool valid = false;
+            std::uint64_t version = 0;
+            std::vector<Candle> candles;
+        };
+
+        const OrderBook& book;
+        CandlePyramid pyramid;
+        /** the last tick read, if read is set */
+        std::int64_t cursor;
+        bool read;
+        std::map<std::pair<SymbolId, std::size_t>, Cached> cache;
+};
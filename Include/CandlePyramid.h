@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CandleAggregator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Candles of one stream at several resolutions, e.g. 1s, 1m, 5m, 1h, 1d.
+ * Events only go into the finest level. A candle that closes there is
+ * folded into the level above, and so on up, so every level is kept up to
+ * date for O(levels) work per closed candle. Switching timeframe is then a
+ * lookup. Every level holds a bounded number of closed candles, so memory
+ * stays flat over long histories.
+ */
+class CandlePyramid
+{
+    public:
+        /** 1 second, 1 minute, 5 minutes, 1 hour and 1 day, in ticks */
+        static std::vector<std::int64_t> defaultIntervals();
+
+        /** intervals in ticks, each a multiple of the one before it; ones
+         * that are not are skipped. capacity closed candles are kept per
+         * level and product, 0 keeps them all */
+        explicit CandlePyramid(std::vector<std::int64_t> intervals = defaultIntervals(),
+                               std::size_t capacity = 2048);
+
+        /** fold a trade or quote, see CandleAggregator::add */
+        bool add(SymbolId product, std::int64_t timestamp, double price, double amount);
+        bool add(const OrderBookEntry& entry);
+        bool add(SymbolId product, std::int64_t timestamp, const PriceStats& stats);
+
+        std::size_t levelCount() const { return levels.size(); }
+        std::int64_t getInterval(std::size_t level) const { return levels[level].getInterval(); }
+        /** the coarsest level whose interval is at most interval, 0 if none is */
+        std::size_t levelFor(std::int64_t interval) const;
+
+        /** candles of product at level, oldest first. The last ones are in
+         * progress and include what the finer levels have not handed up yet */
+        std::vector<Candle> getCandles(SymbolId product, std::size_t level) const;
+        /** changes whenever a candle of product does, at any level */
+        std::uint64_t getVersion(SymbolId product) const { return levels.front().getVersion(product); }
+
+        /** forget every candle */
+        void clear();
+
+    private:
+        /** hand the candles closed by the last add up the levels */
+        void rollUp(SymbolId product, std::int64_t previousStart, bool hadLive);
+
+        std::vector<CandleAggregator> levels;
+};
@@ -4,6 +4,7 @@
 #include <string> 
 #include <map>
 #include <iostream>
+#include "CandleAggregator.h"
 #include "OrderBook.h"
 #include "OrderBookEntry.h"
 
@@ -21,11 +22,11 @@ class CandleStick
     public:
         /** Default constructor */
         CandleStick();
-        /** Calculate and return candles values */
-        static std::map<std::string, std::vector<Candlestick>> calculateCandlestickDetails(OrderBook& orderBook, std::string& timestamp, OrderBookType orderType, std::vector<OrderBookEntry>& selectedOrders);
-
         /** Filter timestamp to be displayed on x-axis*/
-        static std::string filterTimestamp(std::string& timestamp);
+        static std::string filterTimestamp(const std::string& timestamp);
+
+        /** Candle of a CandleAggregator in the shape the printers take */
+        static Candlestick toCandlestick(const Candle& candle);
 
         // ANSI color codes
         const std::string ANSI_RESET = "\033[0m";
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ReplayEngine;
+
+/** Append-only file of replay checkpoints.
+ *
+ * A checkpoint holds what a replay adds on top of its dataset: inserted
+ * orders not yet matched, open orders, persistent live books, pending
+ * fills, the wallet and the replay cursor. Orders inserted at times the
+ * replay has already matched are not kept, so a restored book only shows
+ * them while they are open. The dataset itself is not written, restoring
+ * assumes the book was loaded from the same one. Strategies keep their
+ * own state.
+ *
+ * Layout (native byte order):
+ *   FileHeader
+ *   per checkpoint: RecordHeader, then size bytes of payload
+ *
+ * Checkpoints are only ever appended, so a replay can write one every few
+ * ticks as it goes. A record cut short by a crash is dropped on open.
+ */
+class CheckpointLog
+{
+    public:
+        static constexpr std::uint32_t formatVersion = 1;
+
+        /** open the log, creating it on the first append if it does not exist */
+        explicit CheckpointLog(std::string filename);
+
+        /** false if the file exists but is not a checkpoint log */
+        bool isOpen() const { return valid; }
+        std::size_t size() const { return records.size(); }
+        /** replay cursor of each checkpoint, in the order they were written */
+        std::vector<std::int64_t> getCursors() const;
+
+        /** write the state of replay, its book and its wallet as a new checkpoint */
+        bool append(const ReplayEngine& replay);
+        /** put replay, its book and its wallet back to checkpoint index */
+        bool restore(std::size_t index, ReplayEngine& replay) const;
+        /** restore the latest checkpoint written at or before timestamp,
+         * false if there is none */
+        bool seek(std::int64_t timestamp, ReplayEngine& replay) const;
+
+    private:
+        struct FileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;
+        };
+        struct RecordHeader
+        {
+            std::uint64_t size;
+            /** replay cursor, INT64_MAX once the replay has finished */
+            std::int64_t cursor;
+        };
+        struct Record
+        {
+            std::uint64_t offset;
+            std::uint64_t size;
+            std::int64_t cursor;
+        };
+
+        /** read the headers of an existing log, dropping a torn last record */
+        bool index();
+
+        std::string filename;
+        bool valid;
+        std::uint64_t end;
+        std::vector<Record> records;
+};
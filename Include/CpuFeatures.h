@@ -0,0 +1,30 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPUFEATURES_X86 1
+#endif
+
+/** marks a function built for AVX2 in a file compiled for the baseline,
+ * it may only run once CpuFeatures has said the CPU supports it */
+#if defined(CPUFEATURES_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CPUFEATURES_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CPUFEATURES_TARGET_AVX2
+#endif
+
+/** Instruction set the vectorised kernels, CSVScanner and PriceStats, run
+ * with. The widest one the CPU supports is picked at runtime, once for
+ * every kernel, so forcing it affects them all.
+ */
+class CpuFeatures
+{
+    public:
+        enum class Isa { scalar, sse2, avx2 };
+
+        /** widest instruction set the CPU and the OS support */
+        static Isa detectIsa();
+        /** instruction set the kernels are currently using */
+        static Isa activeIsa();
+        /** override the runtime choice (benchmarks), falls back if unsupported */
+        static void forceIsa(Isa isa);
+};
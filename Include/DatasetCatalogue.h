@@ -0,0 +1,59 @@
+#pragma once
+
+#include "OrderBook.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** The dataset files of a directory, e.g. one csv or snapshot per day,
+ * indexed by the time range each one covers.
+ *
+ * Files are only read when a replay reaches their time range, and files
+ * more than a retention window behind it are unloaded again, so memory is
+ * bounded by the window rather than by the length of the data.
+ */
+class DatasetCatalogue
+{
+    public:
+        struct Day
+        {
+            std::string path;
+            /** first and last timestamp the file covers, in ticks */
+            std::int64_t first;
+            std::int64_t last;
+        };
+
+        /** index the .csv and .obsnap files of directory, keeping up to
+         * retain days loaded before the one being replayed. A file named
+         * by day, e.g. 20200317.csv, covers that whole day and must hold
+         * only its orders; any other file is read once for its time range.
+         * Files whose range overlaps an earlier file are skipped */
+        explicit DatasetCatalogue(const std::string& directory, std::size_t retain = 1);
+
+        /** indexed files, oldest first. A file that fails to load when the
+         * replay reaches it is dropped, with a message naming it */
+        const std::vector<Day>& getDays() const { return days; }
+        bool empty() const { return days.empty(); }
+
+        /** load the day covering timestamp, or the first one after it, into
+         * book and unload the days outside the window. A day that cannot be
+         * loaded is skipped for the next one. false if there is no such day */
+        bool seek(OrderBook& book, std::int64_t timestamp);
+        /** load the first day starting after timestamp, when the replay has
+         * run out of loaded data, skipping days that cannot be loaded.
+         * false once there are no more days */
+        bool loadNext(OrderBook& book, std::int64_t timestamp);
+
+    private:
+        /** time range of a csv file or snapshot, from its name if it is
+         * named by day, otherwise from its timestamps */
+        static bool readRange(const std::string& path, std::int64_t& first, std::int64_t& last);
+        /** make day i and the retained days before it the loaded ones,
+         * dropping the files that fail to load. false if no day from i on
+         * can be loaded */
+        bool show(OrderBook& book, std::size_t i);
+
+        std::vector<Day> days;
+        std::size_t retain;
+};
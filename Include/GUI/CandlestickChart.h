@@ -15,11 +15,14 @@
 #include <QtCharts/QDateTimeAxis>
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QLineSeries>
+#include <deque>
 #include <vector>
 #include <memory>
 
 #include "../OrderBook.h"
 #include "../CandleStick.h"
+#include "../CandleFeed.h"
+#include "../RollingMean.h"
 
 class CandlestickChart : public QWidget
 {
@@ -31,7 +34,7 @@ public:
     ~CandlestickChart();
     
     void setOrderBook(OrderBook* orderBook);
-    void updateChart(const std::string& currentTime);
+    void updateChart(const std::string& time);
     void setSelectedProduct(const std::string& product);
 
 public slots:
@@ -52,6 +55,13 @@ private:
     void updateVolumeData();
     void addMovingAverage(int period);
     void clearChart();
+    // incremental drawing, see updateChart
+    void redrawCandles(const std::vector<Candle>& candles, std::int64_t from);
+    void appendCandle(const Candle& candle);
+    void replaceLastCandle(const Candle& candle);
+    void trimCandlesBefore(std::int64_t from);
+    void rescaleAxes();
+    QCandlestickSet* takeSet(const Candle& candle);
     
     std::vector<Candlestick> getCandlestickData(const std::string& product, const std::string& timeframe);
     QDateTime stringToDateTime(const std::string& timestamp);
@@ -90,6 +100,8 @@ private:
     
     // Data
     OrderBook *orderBook;
+    // candles of the book's quotes, cached per product and level
+    std::unique_ptr<CandleFeed> feed;
     CandleStick candleStick;
     std::string selectedProduct;
     std::string selectedTimeframe;
@@ -103,8 +115,23 @@ private:
     bool ma50Visible;
     double minPrice;
     double maxPrice;
+    // what the series show, so a refresh without new ticks redraws nothing
+    bool drawn;
+    int drawnDays;
+    SymbolId drawnProduct;
+    std::size_t drawnLevel;
+    std::uint64_t drawnVersion;
+    // the candles on screen, oldest first, and the sets drawing them
+    std::deque<Candle> shownCandles;
+    std::deque<QCandlestickSet*> shownSets;
+    // sets taken off the series, reused before new ones are allocated
+    std::vector<QCandlestickSet*> setPool;
+    // running over every candle up to the newest shown one
+    RollingMean ma20;
+    RollingMean ma50;
     
     // Constants
     static const QStringList AVAILABLE_PRODUCTS;
     static const QStringList AVAILABLE_TIMEFRAMES;
+    static const int MAX_CANDLES = 300; // per timeframe, picks the candle interval
 };
\ No newline at end of file
@@ -38,6 +38,7 @@ signals:
 
 public slots:
     void onCancelOrder();
+    void onCancelAllOrders();
     void onModifyOrder();
     void onRefreshOrders();
     void onFilterChanged();
@@ -57,6 +58,8 @@ private:
     void applyFilters();
     void showOrderDetails(const OrderBookEntry& order);
     void calculateTradeStatistics();
+    /** id of the order in the selected row, 0 if nothing is selected */
+    OrderId selectedOrderId() const;
     
     // UI Components
     QVBoxLayout *mainLayout;
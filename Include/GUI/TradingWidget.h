@@ -56,6 +56,7 @@ private:
     void setupQuickTrade();
     void connectSignals();
     void updatePriceDisplay();
+    void refreshProducts();
     void updateOrderBookDisplay();
     void validateOrderForm();
     void executeOrder(bool isBuy);
@@ -85,6 +86,7 @@ private:
     QButtonGroup *orderTypeGroup;
     QRadioButton *marketOrderRadio;
     QRadioButton *limitOrderRadio;
+    QComboBox *timeInForceCombo;
     QDoubleSpinBox *priceSpinBox;
     QDoubleSpinBox *amountSpinBox;
     QLabel *totalLabel;
@@ -113,6 +115,8 @@ private:
     std::shared_ptr<User> currentUser;
     std::string selectedProduct;
     std::string currentTime;
+    // catalogue version the product list was last filled from
+    std::uint64_t productsVersion;
     
     // Market data
     double currentPrice;
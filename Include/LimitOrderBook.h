@@ -0,0 +1,133 @@
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/** Resting orders of one product, matched with price-time priority.
+ *
+ * Each side is a sorted map of price levels, every level a FIFO queue of
+ * the orders resting at that price. An incoming order trades against the
+ * best opposite levels for as long as it crosses, then rests whatever is
+ * left. The cost is proportional to the number of fills plus a log of
+ * the number of levels, never to the size of the book.
+ *
+ * Resting orders are indexed by id, so cancel and amend go straight to
+ * the order instead of searching for it.
+ */
+class LimitOrderBook
+{
+    public:
+        /** one trade between an incoming order and a resting one */
+        struct Fill
+        {
+            /** price of the resting order */
+            double price;
+            double amount;
+            /** timestamp of the incoming order */
+            std::int64_t timestamp;
+            SymbolId product;
+            SymbolId buyer;
+            SymbolId seller;
+            /** side of the incoming order */
+            OrderBookType takerSide;
+            OrderId takerId;
+            OrderId makerId;
+        };
+
+        explicit LimitOrderBook(SymbolId product);
+        /** copies point their locators at their own levels */
+        LimitOrderBook(const LimitOrderBook& other);
+        LimitOrderBook& operator=(const LimitOrderBook& other);
+        LimitOrderBook(LimitOrderBook&&) = default;
+        LimitOrderBook& operator=(LimitOrderBook&&) = default;
+
+        /** match a bid or ask against the book, appending a Fill per trade.
+         * A limit order rests its unfilled amount, the other kinds drop it and
+         * a fok order that cannot fill completely does not trade at all.
+         * An order without an id gets one, one already resting here is
+         * ignored. returns the amount that traded */
+        double submit(const OrderBookEntry& order, std::vector<Fill>& fills);
+        /** take up to amount off owner's orders resting at a price, newest
+         * first so the oldest keep their priority. returns the amount removed */
+        double reduce(OrderBookType side, double price, double amount, SymbolId owner);
+
+        /** remove a resting order, false if it is not in the book. O(1) */
+        bool cancel(OrderId id);
+        /** change the amount of a resting order. Going down keeps its place
+         * in the queue, going up moves it to the back, 0 cancels it. O(1) */
+        bool amend(OrderId id, double amount);
+        /** move a resting order to a new price, losing its priority.
+         * It is matched again at the new price, keeping its id */
+        bool amend(OrderId id, double price, double amount, std::vector<Fill>& fills);
+        /** the resting order with this id, nullptr if there is none */
+        const OrderBookEntry* find(OrderId id) const;
+        /** every resting order, bids then asks, best level first and in
+         * queue order within a level. submitting them in this order to an
+         * empty book rebuilds this one */
+        std::vector<OrderBookEntry> getResting() const;
+
+        /** false if that side is empty */
+        bool bestBid(double& price) const;
+        bool bestAsk(double& price) const;
+        /** amount an incoming order of this side could take at prices up to
+         * limit (down to, for an ask), stopping once wanted is reached.
+         * Sums the orders it would trade with, so it costs no more than
+         * matching them */
+        double available(OrderBookType side, double limit, double wanted) const;
+        /** total amount resting at a price, 0 if there is no such level */
+        double amountAt(OrderBookType side, double price) const;
+        std::size_t levelCount(OrderBookType side) const;
+        std::size_t orderCount() const { return locators.size(); }
+        bool empty() const { return locators.empty(); }
+        void clear();
+
+        SymbolId getProduct() const { return product; }
+
+        /** true if amount is only the rounding left over from taking amounts
+         * off something of size scale, e.g. 3e-16 of a 0.3 order */
+        static bool isDust(double amount, double scale) { return amount <= scale * dustRatio; }
+
+    private:
+        static constexpr double dustRatio = 1e-9;
+
+        using Queue = std::list<OrderBookEntry>;
+        struct Level
+        {
+            Queue orders;
+            /** sum of the amounts in orders, up to rounding */
+            double total = 0;
+        };
+        // best level first on both sides
+        using BidLevels = std::map<double, Level, std::greater<double>>;
+        using AskLevels = std::map<double, Level>;
+        /** where a resting order lives, map nodes and list nodes never move */
+        struct Locator
+        {
+            Level* level;
+            Queue::iterator order;
+        };
+
+        template <typename Levels, typename Crosses>
+        double match(Levels& levels, OrderBookEntry& order, Crosses crosses, std::vector<Fill>& fills);
+        template <typename Levels>
+        void rest(Levels& levels, const OrderBookEntry& order);
+        template <typename Levels, typename Crosses>
+        static double sumLevels(const Levels& levels, Crosses crosses, double wanted);
+        template <typename Levels>
+        double reduceLevel(Levels& levels, double price, double amount, SymbolId owner);
+        template <typename Levels>
+        void relocate(Levels& levels);
+        /** unlink an order from its level, dropping the level once it is empty */
+        void remove(const Locator& at);
+
+        SymbolId product;
+        BidLevels bids;
+        AskLevels asks;
+        std::unordered_map<OrderId, Locator> locators;
+};
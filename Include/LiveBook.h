@@ -0,0 +1,50 @@
+#pragma once
+
+#include "LimitOrderBook.h"
+#include "OrderRange.h"
+#include <map>
+#include <utility>
+#include <vector>
+
+/** Persistent book of one product for replaying a dataset tick by tick.
+ *
+ * Each tick of a dataset lists the whole market. Rather than rebuilding
+ * the book from it, a LiveBook keeps the dataset amount per price level
+ * from the previous tick and applies only the difference: shrunk levels
+ * are reduced, grown or new levels are submitted as fresh liquidity.
+ * Other users' orders rest across ticks until they are filled.
+ */
+class LiveBook
+{
+    public:
+        /** dataset amount resting at one price of one side */
+        struct Level
+        {
+            OrderBookType side;
+            double price;
+            double amount;
+        };
+
+        explicit LiveBook(SymbolId product);
+
+        /** move to the next tick, asks and bids being every order of the
+         * product stamped with it. appends the trades this causes */
+        void advance(OrderRange asks, OrderRange bids, std::vector<LimitOrderBook::Fill>& fills);
+
+        const LimitOrderBook& getBook() const { return book; }
+        /** for cancelling and amending resting orders */
+        LimitOrderBook& getBook() { return book; }
+
+        /** dataset levels as of the previous tick */
+        std::vector<Level> getDatasetLevels() const;
+        /** put the book back the way getBook().getResting() and
+         * getDatasetLevels() described it */
+        void restore(const std::vector<OrderBookEntry>& resting, const std::vector<Level>& levels);
+
+    private:
+        using LevelKey = std::pair<OrderBookType, double>;
+
+        LimitOrderBook book;
+        /** dataset amount per (side, price) as of the previous tick */
+        std::map<LevelKey, double> datasetLevels;
+};
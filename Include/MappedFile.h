@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+/** Read-only view of a whole file mapped into memory.
+ * The mapping is released when the object goes out of scope.
+ */
+class MappedFile
+{
+    public:
+        MappedFile();
+        /** map the file, isOpen() reports whether it worked */
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return opened; }
+        const char* data() const { return mapped; }
+        std::size_t size() const { return length; }
+        std::string_view view() const { return std::string_view{mapped, length}; }
+
+    private:
+        void release();
+
+        const char* mapped;
+        std::size_t length;
+        bool opened;
+#ifdef _WIN32
+        // no mmap here, the file is read into this buffer instead
+        std::string buffer;
+#endif
+};
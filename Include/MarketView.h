@@ -0,0 +1,47 @@
+#pragma once
+
+#include "OrderBook.h"
+#include "OrderRange.h"
+#include "SymbolTable.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Read-only, zero-copy look at the book at one replay tick.
+ * The ranges point straight into the OrderBook, so a strategy pays for a
+ * binary search per query, never for a copy of the entries.
+ */
+class MarketView
+{
+    public:
+        MarketView(const OrderBook& _book, std::int64_t _timestamp)
+        : book{_book}, timestamp{_timestamp} {}
+
+        /** products in the dataset, sorted by name */
+        const std::vector<std::string>& getProducts() const { return book.getKnownProducts(); }
+        /** the tick being replayed, in microseconds */
+        std::int64_t getTimestamp() const { return timestamp; }
+
+        OrderRange getAsks(SymbolId product) const
+        {
+            return book.getOrders(OrderBookType::ask, product, timestamp);
+        }
+        OrderRange getBids(SymbolId product) const
+        {
+            return book.getOrders(OrderBookType::bid, product, timestamp);
+        }
+        /** same, by product name. unknown products have no orders */
+        OrderRange getAsks(const std::string& product) const { return byName(OrderBookType::ask, product); }
+        OrderRange getBids(const std::string& product) const { return byName(OrderBookType::bid, product); }
+
+    private:
+        OrderRange byName(OrderBookType side, const std::string& product) const
+        {
+            SymbolId id;
+            if (!SymbolTable::products().find(product, id)) return OrderRange{};
+            return book.getOrders(side, id, timestamp);
+        }
+
+        const OrderBook& book;
+        std::int64_t timestamp;
+};
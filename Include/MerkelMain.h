@@ -5,6 +5,8 @@
 #include "OrderBook.h"
 #include "Wallet.h"
 #include "CandleStick.h"
+#include "DatasetCatalogue.h"
+#include "ReplayEngine.h"
 
 class MerkelMain
 {
@@ -22,6 +24,9 @@ class MerkelMain
         
         /** Move to next timeframe */
         void gotoNextTimeframe();
+
+        /** Let a strategy trade for the simuser on every timeframe, nullptr for none */
+        void setStrategy(Strategy* strategy) { replay.setStrategy(strategy); }
         
         /** Get market statistics */
         void getMarketStats(const std::string& product, double& currentPrice, double& volume, double& change);
@@ -43,14 +48,20 @@ class MerkelMain
         void printWallet();
         void printCandleChart();
         void getPrices();
+        /** one candle per known timestamp of product, from its orders of type */
+        std::vector<Candle> buildCandles(const std::string& product, OrderBookType type);
         int getUserOption();
         void processUserOption(int userOption);
 
         std::string currentTime;
 
-        OrderBook orderBook{"20200601.csv"};
+        /** the daily files in data/, loaded into orderBook as the replay reaches them */
+        DatasetCatalogue datasets{"data"};
+        OrderBook orderBook;
 
         Wallet wallet;
+        /** steps orderBook for gotoNextTimeframe, declared after what it uses */
+        ReplayEngine replay{orderBook, wallet};
         // object of CandleStick class
         CandleStick candle;
         // object of Candlestick structure
@@ -1,47 +1,246 @@
 #pragma once
 #include "OrderBookEntry.h"
 #include "CSVReader.h"
+#include "OrderRange.h"
+#include "LiveBook.h"
+#include "PriceStats.h"
+#include "ProductCatalogue.h"
+#include "SymbolTable.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <utility>
+#include <unordered_map>
 
+/** how matchAsksToBids treats orders that do not trade */
+enum class MatchMode
+{
+    /** every tick is matched on its own, residuals are dropped */
+    perTick,
+    /** residuals rest in a per-product LiveBook and carry into later ticks */
+    persistent
+};
+
+/** Orders of one or more datasets, indexed by (timestamp, product, side).
+ *
+ * Loaded datasets, e.g. one per day, are immutable and shared by every copy
+ * of the book. Inserting, cancelling or amending orders gives the copy its
+ * own version of the one (timestamp, product, side) run involved, so copying
+ * a book costs its timeline and catalogue, not its orders.
+ */
 class OrderBook
 {
     public:
         OrderBook();
-        /** construct, reading a csv data file */
+        /** construct, reading a csv data file or a binary snapshot */
         OrderBook(std::string filename);
-        /** return vector of all know products in the dataset*/
-        std::vector<std::string> getKnownProducts();
-        /** return vector of Orders according to the sent filters*/
-        std::vector<OrderBookEntry> getOrders(OrderBookType type, 
-                                              std::string product, 
-                                              std::string timestamp);
+        /** construct, reading a csv data file with the given ingestion mode,
+         * binary snapshots are detected and mapped instead */
+        OrderBook(std::string filename, CSVReader::ReadMode mode);
+
+        /** add the orders of another csv file or snapshot, e.g. the next day.
+         * false if it cannot be read or its time range overlaps loaded data */
+        bool loadDataset(const std::string& filename,
+                         CSVReader::ReadMode mode = CSVReader::ReadMode::mapped);
+        /** same, for entries already in memory */
+        bool addDataset(std::vector<OrderBookEntry> entries);
+        /** drop the datasets lying wholly within [from, to], together with
+         * the orders inserted at their times */
+        void unloadDatasets(std::int64_t from, std::int64_t to);
+        /** first and last timestamp of each loaded dataset, oldest first */
+        std::vector<std::pair<std::int64_t, std::int64_t>> getDatasetRanges() const;
+        /** return all known products in the dataset, sorted by name.
+         * The reference stays valid, and is kept up to date, for the life of the book */
+        const std::vector<std::string>& getKnownProducts() const;
+        /** return the Orders matching the sent filters, as a view into the book.
+         * O(log N) - the book is kept sorted by (timestamp, product, side) */
+        OrderRange getOrders(OrderBookType type, 
+                             std::string product, 
+                             std::string timestamp);
+        /** same filter on interned product id and timestamp ticks */
+        OrderRange getOrders(OrderBookType type,
+                             SymbolId product,
+                             std::int64_t timestamp) const;
 
         /** returns the earliest time in the orderbook*/
         std::string getEarliestTime();
+        /** returns the latest time in the orderbook*/
+        std::string getLatestTime();
 
         // double getOpeningPrice();
-        std::vector<std::string> getKnownTimestamps(std::string product);
+        /** return the known timestamps of a product, oldest first */
+        const std::vector<std::string>& getKnownTimestamps(const std::string& product) const;
+        /** products and timestamps with their change counters */
+        const ProductCatalogue& getCatalogue() const { return catalogue; }
 
         /** returns the next time after the 
          * sent time in the orderbook  
          * If there is no next timestamp, wraps around to the start
          * */
         std::string getNextTime(std::string timestamp);
-        void insertOrder(OrderBookEntry& order);
+        /** returns the time before the sent time,
+         * wrapping around to the end */
+        std::string getPreviousTime(std::string timestamp);
+        /** returns the first time at or after the sent time,
+         * the latest time if there is none */
+        std::string seekTime(std::string timestamp);
+        /** returns every time in [from, to], oldest first */
+        std::vector<std::string> getTimesInRange(std::string from, std::string to);
+        /** distinct timestamps of the book in ticks, ascending */
+        const std::vector<std::int64_t>& getTimeline() const { return timeline; }
+        /** place an order in the book, after any orders with the same key.
+         * Binary search finds the slot, no re-sort. returns the order's id,
+         * assigning a new one if it had none */
+        OrderId insertOrder(const OrderBookEntry& order);
+        /** insert many orders: only the batch is sorted, then merged in once */
+        void insertOrders(std::vector<OrderBookEntry> batch);
+
+        /** cancel a user order that is still open, false if there is none.
+         * O(1) apart from finding its run */
+        bool cancelOrder(OrderId id);
+        /** change the amount of an open user order, keeping its priority
+         * unless the amount grows. 0 cancels. O(1) apart from finding its run */
+        bool amendOrder(OrderId id, double amount);
+        /** move an open user order to a new price, it loses its priority.
+         * trades this causes in a persistent book come out of the next
+         * matchAsksToBids for the product */
+        bool amendOrder(OrderId id, double price, double amount);
+        /** open orders of a user, oldest first */
+        std::vector<OrderBookEntry> getOpenOrders(const std::string& username) const;
 
         std::vector<OrderBookEntry> matchAsksToBids(std::string product, std::string timestamp);
+        /** match every known product at timestamp, each product a shard of
+         * its own on the pool. returns the sales of each product in
+         * getKnownProducts() order, the same as matchAsksToBids one by one */
+        std::vector<std::vector<OrderBookEntry>> matchAllProducts(const std::string& timestamp,
+                                                                  ThreadPool& pool);
+        /** same, at a timestamp in ticks */
+        std::vector<std::vector<OrderBookEntry>> matchAllProducts(std::int64_t timestamp, ThreadPool& pool);
+        /** switching mode drops any resting orders of the persistent mode */
+        void setMatchMode(MatchMode mode);
+        MatchMode getMatchMode() const { return matchMode; }
+        /** the persistent book of a product, nullptr until it has been matched */
+        const LiveBook* getLiveBook(const std::string& product) const;
 
-        static double getHighPrice(std::vector<OrderBookEntry>& orders, std::string product);
-        static double getLowPrice(std::vector<OrderBookEntry>& orders, std::string product);
+        /** everything the book holds beyond its dataset, see CheckpointLog */
+        struct State
+        {
+            struct Live
+            {
+                SymbolId product;
+                std::vector<OrderBookEntry> resting;
+                std::vector<LiveBook::Level> levels;
+            };
 
-        /** Calculate close values*/
-        static double getAveragePrice(std::vector<OrderBookEntry>& orders, std::string product);
+            MatchMode matchMode = MatchMode::perTick;
+            /** orders inserted since the dataset was loaded, by key and
+             * in arrival order within a key */
+            std::vector<OrderBookEntry> inserted;
+            /** open user orders with what is left of them */
+            std::vector<OrderBookEntry> open;
+            std::vector<Live> liveBooks;
+            std::vector<std::pair<SymbolId, std::vector<LimitOrderBook::Fill>>> pendingFills;
+        };
+        State getState() const;
+        /** go back to the dataset alone, then apply state */
+        void setState(const State& state);
+
+        /** price and amount figures of the orders of product, in one pass */
+        static PriceStats getPriceStats(OrderRange orders, SymbolId product);
+        static PriceStats getPriceStats(OrderRange orders, const std::string& product);
+
+        /** highest and lowest price of product, 0 if it has no orders */
+        static double getHighPrice(OrderRange orders, std::string product);
+        static double getLowPrice(OrderRange orders, std::string product);
+
+        /** Calculate close values, 0 if product has no orders */
+        static double getAveragePrice(OrderRange orders, std::string product);
 
         // get ROI
-        static double getROI(std::vector<OrderBookEntry>& orders);
+        static double getROI(OrderRange orders);
    
     private:
-        std::vector<OrderBookEntry> orders;
+        /** translate user-facing strings to the keys stored in the entries,
+         * false if the product is unknown or the timestamp does not parse */
+        static bool toKeys(const std::string& product, const std::string& timestamp,
+                           SymbolId& productId, std::int64_t& ticks);
+        /** timeline and catalogue from the loaded datasets and inserted runs,
+         * plus the products that still have live books or open user orders */
+        void rebuildIndex();
+        /** add sorted, distinct timestamps to the timeline */
+        void mergeIntoTimeline(const std::vector<std::int64_t>& times);
+        void addToTimeline(std::int64_t timestamp);
+        /** ticks of a user-facing timestamp, unreadable ones sort before everything */
+        static std::int64_t toTicks(const std::string& timestamp);
+        /** turn fills into the sale entries handed to the wallet.
+         * a simuser sale carries the id of the simuser's order */
+        static std::vector<OrderBookEntry> toSales(const std::vector<LimitOrderBook::Fill>& fills,
+                                                   SymbolId product, std::int64_t timestamp);
+        /** matching is split in three so products can be matched in parallel:
+         * beginShard and settleShard touch state shared between products and
+         * run on one thread, matchShard only writes to its own live book and fills.
+         * beginShard picks up the product's pending fills and returns its live
+         * book, nullptr when matching per tick */
+        LiveBook* beginShard(SymbolId product, std::vector<LimitOrderBook::Fill>& fills);
+        void matchShard(SymbolId product, std::int64_t timestamp, LiveBook* live,
+                        std::vector<LimitOrderBook::Fill>& fills) const;
+        /** track the fills from first on and drop finished user orders, then
+         * turn all fills into sales */
+        std::vector<OrderBookEntry> settleShard(SymbolId product, std::int64_t timestamp,
+                                                const std::vector<LimitOrderBook::Fill>& fills,
+                                                std::size_t first);
+        /** remember a user order sitting at slot of its run, so it can be
+         * cancelled or amended later */
+        void trackPlaced(OrderBookEntry& order, std::size_t slot);
+        /** take filled amounts off the open user orders */
+        void trackFills(const std::vector<LimitOrderBook::Fill>& fills);
+        using RunKey = std::tuple<std::int64_t, SymbolId, OrderBookType>;
+        static RunKey runKey(const OrderBookEntry& e) { return RunKey{e.timestamp, e.product, e.orderType}; }
+        /** one loaded dataset, its entries sorted by (timestamp, product, side),
+         * which getOrders relies on */
+        struct Segment
+        {
+            std::int64_t first;
+            std::int64_t last;
+            std::shared_ptr<const std::vector<OrderBookEntry>> orders;
+        };
+
+        /** the loaded entries with the key of key */
+        OrderRange datasetRun(const OrderBookEntry& key) const;
+        /** this book's own copy of the run with the key of key, made on first use */
+        std::vector<OrderBookEntry>& ownRun(const OrderBookEntry& key);
+        /** own copy of a run, nullptr if it was never modified */
+        std::vector<OrderBookEntry>* findRun(const OrderBookEntry& key);
+        /** an open user order and the index of its slot in its own run */
+        struct Placed
+        {
+            OrderBookEntry order;
+            std::size_t slot;
+        };
+        /** the slot of a placed order and the run holding it, nullptr if
+         * the run has been dropped since */
+        OrderBookEntry* locate(const Placed& placed, std::vector<OrderBookEntry>*& run);
+        /** cancel the order's slot and append a copy to the back of its run,
+         * where it loses its priority. returns the new slot */
+        OrderBookEntry* requeue(Placed& placed, std::vector<OrderBookEntry>& run);
+
+        /** loaded datasets, oldest first, their time ranges never overlap */
+        std::vector<Segment> segments;
+        /** runs this book has modified, they hide the dataset's run of the same key.
+         * Orders are only ever appended, a cancelled one keeps its slot
+         * marked cancelled, so the slots of placed orders never move */
+        std::map<RunKey, std::vector<OrderBookEntry>> runs;
+        /** distinct timestamps of orders, ascending */
+        std::vector<std::int64_t> timeline;
+        ProductCatalogue catalogue;
+        MatchMode matchMode = MatchMode::perTick;
+        std::unordered_map<SymbolId, LiveBook> liveBooks;
+        /** user orders that have not been filled, cancelled or dropped */
+        std::unordered_map<OrderId, Placed> placed;
+        /** trades caused by amendOrder, reported with the next match */
+        std::unordered_map<SymbolId, std::vector<LimitOrderBook::Fill>> pendingFills;
 };
@@ -1,41 +1,93 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include "SymbolTable.h"
 
-enum class OrderBookType{bid, ask, unknown, asksale, bidsale};
+enum class OrderBookType : std::uint8_t {bid, ask, unknown, asksale, bidsale};
 
+/** how an order trades.
+ * limit: trades up to its price, the rest stays in the book
+ * market: sweeps levels at any price, the rest is cancelled
+ * ioc: immediate-or-cancel, trades up to its price, the rest is cancelled
+ * fok: fill-or-kill, trades its whole amount up to its price or nothing */
+enum class OrderKind : std::uint8_t {limit, market, ioc, fok};
+
+/** unique order identifier, 0 until the order is placed in a book */
+using OrderId = std::uint64_t;
+
+/** One order or sale. Products and usernames are stored as interned ids
+ * and the timestamp as microsecond ticks, which keeps an entry at 40 bytes
+ * and turns every filter into an integer compare.
+ */
 class OrderBookEntry
 {
     public:
 
+        /** throws std::invalid_argument if the timestamp cannot be parsed */
         OrderBookEntry( double _price, 
                         double _amount, 
-                        std::string _timestamp, 
-                        std::string _product, 
+                        std::string_view _timestamp, 
+                        std::string_view _product, 
                         OrderBookType _orderType,
 //if user does not exist this will set the new data to dataset(default)
-                        std::string username = "dataset");
+                        std::string_view username = "dataset");
+
+        /** construct from already parsed / interned keys */
+        OrderBookEntry( double _price,
+                        double _amount,
+                        std::int64_t _timestamp,
+                        SymbolId _product,
+                        OrderBookType _orderType,
+                        SymbolId _username = datasetUser());
+
+        static OrderBookType stringToOrderBookType(std::string_view s);
 
-        static OrderBookType stringToOrderBookType(std::string s);
+        /** interned id of the "dataset" user that owns the loaded data */
+        static SymbolId datasetUser();
+        /** a process-wide unique, never 0, order id. thread safe */
+        static OrderId newId();
+        /** make newId hand out ids above id, for orders restored from a checkpoint */
+        static void reserveIds(OrderId id);
 
-        static bool compareByTimestamp(OrderBookEntry& e1, OrderBookEntry& e2)
+        static bool compareByTimestamp(const OrderBookEntry& e1, const OrderBookEntry& e2)
         {
             return e1.timestamp < e2.timestamp;
         }  
-        static bool compareByPriceAsc(OrderBookEntry& e1, OrderBookEntry& e2)
+        /** order of the book: timestamp, then product, then side */
+        static bool compareByKey(const OrderBookEntry& e1, const OrderBookEntry& e2)
+        {
+            if (e1.timestamp != e2.timestamp) return e1.timestamp < e2.timestamp;
+            if (e1.product != e2.product) return e1.product < e2.product;
+            return e1.orderType < e2.orderType;
+        }
+        static bool compareByPriceAsc(const OrderBookEntry& e1, const OrderBookEntry& e2)
         {
             return e1.price < e2.price;
         }
-         static bool compareByPriceDesc(OrderBookEntry& e1, OrderBookEntry& e2)
+         static bool compareByPriceDesc(const OrderBookEntry& e1, const OrderBookEntry& e2)
         {
             return e1.price > e2.price;
         }
 
+        /** timestamp formatted as "YYYY/MM/DD HH:MM:SS.ffffff" */
+        std::string getTimestamp() const;
+        const std::string& getProduct() const { return SymbolTable::products().name(product); }
+        const std::string& getUsername() const { return SymbolTable::usernames().name(username); }
+        void setUsername(std::string_view name) { username = SymbolTable::usernames().intern(name); }
+
         double price;
         double amount;
-        std::string timestamp;
-        std::string product;
-        OrderBookType orderType;
+        /** microsecond ticks, see Timestamp */
+        std::int64_t timestamp;
+        OrderId id;
+        SymbolId product;
         // defining new data to set to data file "username"
-        std::string username;
+        SymbolId username;
+        OrderBookType orderType;
+        OrderKind kind;
+        /** the slot of an order cancelled or moved in an OrderBook, OrderRange
+         * skips it */
+        bool cancelled;
 };
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "OrderBookEntry.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Versioned binary, column-oriented copy of an order book dataset.
+ *
+ * Layout (native byte order, every section 8-byte aligned):
+ *   Header
+ *   int64  timestamps[rows]   microsecond ticks, see Timestamp
+ *   double prices[rows]
+ *   double amounts[rows]
+ *   uint16 products[rows]     index into the product table
+ *   uint8  sides[rows]        OrderBookType
+ *   product table             productCount x (uint32 length, chars)
+ *
+ * The file is mmapped read-only, so loads after the first one come from
+ * the page cache and skip parsing. The mapped columns are not what an
+ * OrderBook serves, see toEntries, so a loaded book holds its own copy
+ * and the mapping is only kept while the snapshot object lives.
+ */
+class OrderBookSnapshot
+{
+    public:
+        static constexpr std::uint32_t formatVersion = 1;
+
+        OrderBookSnapshot();
+        /** map a snapshot file, isOpen() is false if it is missing or not valid */
+        explicit OrderBookSnapshot(const std::string& filename);
+
+        /** true if the file starts with the snapshot magic */
+        static bool isSnapshot(const std::string& filename);
+        /** write entries as a snapshot, false if the file cannot be written */
+        static bool write(const std::vector<OrderBookEntry>& entries, const std::string& filename);
+        /** one-shot conversion of a csv dataset, false if it cannot be
+         * read or holds no orders, in which case nothing is written */
+        static bool convertCSV(const std::string& csvFile, const std::string& snapshotFile);
+
+        bool isOpen() const { return valid; }
+        std::size_t size() const { return rowCount; }
+
+        const std::int64_t* timestamps() const { return timestampColumn; }
+        const double* prices() const { return priceColumn; }
+        const double* amounts() const { return amountColumn; }
+        const std::uint16_t* productCodes() const { return productColumn; }
+        const std::uint8_t* sides() const { return sideColumn; }
+        const std::vector<std::string>& products() const { return productNames; }
+
+        /** expand the columns back into order book entries, on the heap.
+         * OrderBook hands out contiguous runs of entries sorted by key, with
+         * process-wide product ids and room for ids and cancellation, none
+         * of which the file order or its product codes give */
+        std::vector<OrderBookEntry> toEntries() const;
+
+    private:
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrder;
+            std::uint64_t rowCount;
+            std::uint64_t productCount;
+            std::uint64_t timestampOffset;
+            std::uint64_t priceOffset;
+            std::uint64_t amountOffset;
+            std::uint64_t productOffset;
+            std::uint64_t sideOffset;
+            std::uint64_t productTableOffset;
+        };
+
+        bool map(const std::string& filename);
+
+        MappedFile file;
+        bool valid;
+        std::size_t rowCount;
+        const std::int64_t* timestampColumn;
+        const double* priceColumn;
+        const double* amountColumn;
+        const std::uint16_t* productColumn;
+        const std::uint8_t* sideColumn;
+        std::vector<std::string> productNames;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "OrderBook.h"
+#include "OrderBookEntry.h"
+#include "SymbolTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** How a Strategy places, cancels and amends its orders.
+ * Requests are queued and reach the book in the order they were made
+ * once the callback returns, so the views a strategy holds stay valid
+ * for the whole callback.
+ */
+class OrderGateway
+{
+    public:
+        /** orders are placed in book, owned by username */
+        OrderGateway(OrderBook& _book, const std::string& username);
+
+        /** queue an order, returns the id it will have in the book */
+        OrderId submit(SymbolId product, OrderBookType side, double price, double amount,
+                       OrderKind kind = OrderKind::limit);
+        /** same, by product name. 0 if the product is not in the dataset */
+        OrderId submit(const std::string& product, OrderBookType side, double price, double amount,
+                       OrderKind kind = OrderKind::limit);
+        /** queue a cancel, see OrderBook::cancelOrder */
+        void cancel(OrderId id);
+        /** queue an amount change, see OrderBook::amendOrder */
+        void amend(OrderId id, double amount);
+        /** queue a price and amount change, see OrderBook::amendOrder */
+        void amend(OrderId id, double price, double amount);
+
+        /** open orders of the strategy, queued requests not included */
+        std::vector<OrderBookEntry> getOpenOrders() const;
+        /** orders submitted so far and their total amount */
+        std::size_t getSubmittedCount() const { return submittedCount; }
+        double getSubmittedAmount() const { return submittedAmount; }
+
+        /** hand the queued requests to the book, new orders stamped with timestamp */
+        void flush(std::int64_t timestamp);
+        /** forget the queued requests */
+        void discard() { pending.clear(); }
+
+    private:
+        enum class Action : std::uint8_t
+        {
+            submit,
+            cancel,
+            amend,
+            move
+        };
+        struct Request
+        {
+            Action action;
+            OrderBookEntry order;
+        };
+
+        OrderBook& book;
+        SymbolId owner;
+        std::vector<Request> pending;
+        std::size_t submittedCount = 0;
+        double submittedAmount = 0;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "OrderBookEntry.h"
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/** Non-owning view of a contiguous run of entries.
+ * A range handed out by OrderBook stays valid until the book is next
+ * modified, e.g. by insertOrder. Cancelled slots, see
+ * OrderBookEntry::cancelled, are skipped.
+ */
+class OrderRange
+{
+    public:
+        class const_iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = OrderBookEntry;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const OrderBookEntry*;
+                using reference = const OrderBookEntry&;
+
+                const_iterator() : at{nullptr}, last{nullptr} {}
+                const_iterator(const OrderBookEntry* _at, const OrderBookEntry* _last)
+                : at{_at}, last{_last} { skip(); }
+
+                reference operator*() const { return *at; }
+                pointer operator->() const { return at; }
+                const_iterator& operator++() { ++at; skip(); return *this; }
+                const_iterator operator++(int) { const_iterator before = *this; ++*this; return before; }
+                bool operator==(const const_iterator& other) const { return at == other.at; }
+                bool operator!=(const const_iterator& other) const { return at != other.at; }
+
+            private:
+                void skip() { while (at != last && at->cancelled) ++at; }
+
+                const OrderBookEntry* at;
+                const OrderBookEntry* last;
+        };
+
+        OrderRange() : first{nullptr}, last{nullptr} {}
+        OrderRange(const OrderBookEntry* _first, const OrderBookEntry* _last)
+        : first{_first}, last{_last} {}
+        /** view a whole vector, which must outlive the range */
+        explicit OrderRange(const std::vector<OrderBookEntry>& entries)
+        : first{entries.data()}, last{entries.data() + entries.size()} {}
+
+        const_iterator begin() const { return const_iterator{first, last}; }
+        const_iterator end() const { return const_iterator{last, last}; }
+        /** number of entries, O(n) as cancelled slots are not counted */
+        std::size_t size() const { return static_cast<std::size_t>(std::distance(begin(), end())); }
+        bool empty() const { return begin() == end(); }
+        /** the first entry, the range must not be empty */
+        const OrderBookEntry& front() const { return *begin(); }
+
+        /** owning copy, for callers that need to sort or modify the entries */
+        std::vector<OrderBookEntry> toVector() const { return std::vector<OrderBookEntry>(begin(), end()); }
+
+    private:
+        const OrderBookEntry* first;
+        const OrderBookEntry* last;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+/** Summary of a set of trades or orders, computed in one pass.
+ * compute() walks contiguous price and amount columns 2 (SSE2) or 4 (AVX2)
+ * doubles per step, with the instruction set picked at runtime, see
+ * CpuFeatures, and a scalar loop everywhere else. Sums are kept in double.
+ */
+struct PriceStats
+{
+    /** lowest and highest price, both 0 when count is 0 */
+    double low = 0;
+    double high = 0;
+    /** sum of the prices */
+    double sum = 0;
+    std::size_t count = 0;
+    /** sum of the amounts */
+    double volume = 0;
+    /** sum of price * amount */
+    double notional = 0;
+
+    /** mean price, 0 when there is nothing */
+    double mean() const { return count == 0 ? 0 : sum / static_cast<double>(count); }
+    /** volume weighted average price, 0 when there is no volume */
+    double vwap() const { return volume == 0 ? 0 : notional / volume; }
+
+    /** add one price and amount */
+    void add(double price, double amount);
+    /** add the figures of another set, e.g. a later part of the same column */
+    void merge(const PriceStats& other);
+
+    /** stats of prices[0, count) with amounts[0, count) */
+    static PriceStats compute(const double* prices, const double* amounts, std::size_t count);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SymbolTable.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** Known products and, per product, the timestamps it trades at.
+ * Maintained incrementally as orders are added, so lookups hand out
+ * references instead of rebuilding lists. The version counters change
+ * whenever the matching list does, letting callers skip refreshing
+ * views that are already up to date.
+ */
+class ProductCatalogue
+{
+    public:
+        ProductCatalogue();
+
+        /** forget everything, both versions move on */
+        void clear();
+        /** record that product has an order at timestamp (ticks) */
+        void add(SymbolId product, std::int64_t timestamp);
+        /** record a product with no timestamps of its own, e.g. one whose
+         * day has been unloaded while it still has orders resting */
+        void add(SymbolId product);
+
+        /** product names, sorted alphabetically */
+        const std::vector<std::string>& getProducts() const { return products; }
+        /** formatted timestamps of a product, oldest first, empty if unknown */
+        const std::vector<std::string>& getTimestamps(SymbolId product) const;
+        const std::vector<std::string>& getTimestamps(std::string_view product) const;
+
+        std::uint64_t productsVersion() const { return productChanges; }
+        std::uint64_t timestampsVersion() const { return timestampChanges; }
+
+    private:
+        struct Times
+        {
+            std::vector<std::int64_t> ticks;
+            std::vector<std::string> formatted;
+        };
+
+        std::vector<std::string> products;
+        std::unordered_map<SymbolId, Times> times;
+        std::uint64_t productChanges;
+        std::uint64_t timestampChanges;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "OrderBook.h"
+#include "OrderBookEntry.h"
+#include "OrderGateway.h"
+#include "ThreadPool.h"
+#include "Wallet.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class CheckpointLog;
+class DatasetCatalogue;
+class Strategy;
+
+/** Steps an OrderBook through its timeline without any UI.
+ * Every step lets the strategy, if there is one, place its orders, matches
+ * all products at the current time, settles the simuser's sales into the
+ * wallet and moves to the next time.
+ */
+class ReplayEngine
+{
+    public:
+        /** counters of the steps taken since the last resetStats */
+        struct Stats
+        {
+            std::size_t ticks = 0;
+            /** dataset and user orders at the ticks that were matched */
+            std::size_t orders = 0;
+            std::size_t fills = 0;
+            /** wall-clock time spent in step, pacing sleeps excluded */
+            double seconds = 0;
+
+            double ticksPerSecond() const { return seconds > 0 ? ticks / seconds : 0; }
+            double ordersPerSecond() const { return seconds > 0 ? orders / seconds : 0; }
+            double fillsPerSecond() const { return seconds > 0 ? fills / seconds : 0; }
+        };
+
+        /** the sales of one product at a step */
+        struct ProductSales
+        {
+            SymbolId product;
+            std::vector<OrderBookEntry> sales;
+        };
+
+        /** replay book from its earliest time, matching on workers threads
+         * (0 = one per core). book and wallet must outlive the engine */
+        ReplayEngine(OrderBook& book, Wallet& wallet, unsigned workers = 0);
+
+        /** drive strategy from the replay, nullptr for none.
+         * the strategy must outlive the engine or be replaced first */
+        void setStrategy(Strategy* _strategy);
+        Strategy* getStrategy() const { return strategy; }
+        /** where the strategy's orders go */
+        const OrderGateway& getGateway() const { return gateway; }
+
+        OrderBook& getBook() { return book; }
+        const OrderBook& getBook() const { return book; }
+        Wallet& getWallet() { return wallet; }
+        const Wallet& getWallet() const { return wallet; }
+
+        /** append a checkpoint to log after every every-th step, nullptr stops.
+         * the log must outlive the engine or be replaced first */
+        void setCheckpoints(CheckpointLog* log, std::size_t every);
+
+        /** replay the days of datasets, loading each one into the book as the
+         * replay reaches it and unloading the days behind it. nullptr replays
+         * whatever the book holds. moves to the start of the first day.
+         * the catalogue must outlive the engine or be replaced first */
+        void setDatasets(DatasetCatalogue* _datasets);
+
+        /** go back to the earliest time of the book */
+        void rewind();
+        /** move to the first time at or after timestamp, finished if there is none */
+        void seek(std::int64_t timestamp);
+        /** true once the latest time has been matched */
+        bool finished() const { return done; }
+        /** the time the next step matches, "" once finished */
+        std::string getCurrentTime() const;
+        std::int64_t getCurrentTick() const { return current; }
+
+        /** match the current time and move on. returns the sales of each
+         * product that was known when it matched, sorted by name and valid
+         * until the next step. Moving on may load or unload a day, so the
+         * book's products can differ from these by the time step returns */
+        const std::vector<ProductSales>& step();
+        /** step until finished. speed 0 replays as fast as possible, otherwise
+         * speed seconds of market time pass per second of wall-clock time */
+        void run(double speed = 0);
+
+        const Stats& getStats() const { return stats; }
+        void resetStats() { stats = Stats{}; }
+
+    private:
+        OrderBook& book;
+        Wallet& wallet;
+        ThreadPool pool;
+        Strategy* strategy;
+        /** the strategy's orders, owned by the simuser */
+        OrderGateway gateway;
+        CheckpointLog* checkpoints;
+        DatasetCatalogue* datasets;
+        std::size_t checkpointEvery;
+        std::size_t sinceCheckpoint;
+        std::int64_t current;
+        bool done;
+        Stats stats;
+        std::vector<ProductSales> sales;
+};
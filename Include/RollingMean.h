@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+/** Mean of the last period values, e.g. a moving average of candle closes.
+ * A running sum makes every update O(1). The sum is recomputed from the
+ * window once per period values, so rounding errors cannot build up.
+ */
+class RollingMean
+{
+    public:
+        explicit RollingMean(std::size_t _period)
+        : window(_period == 0 ? 1 : _period, 0.0), next{0}, count{0}, sum{0} {}
+
+        void push(double value)
+        {
+            sum += value - window[next];
+            window[next] = value;
+            next = (next + 1) % window.size();
+            if (count < window.size()) ++count;
+            if (next == 0) sum = std::accumulate(window.begin(), window.end(), 0.0);
+        }
+
+        /** change the newest value, e.g. the close of a candle still in progress */
+        void replaceLast(double value)
+        {
+            if (count == 0) return push(value);
+            std::size_t last = (next + window.size() - 1) % window.size();
+            sum += value - window[last];
+            window[last] = value;
+        }
+
+        /** true once period values have been pushed */
+        bool ready() const { return count == window.size(); }
+        /** mean of the values pushed so far, up to the last period of them */
+        double value() const { return count == 0 ? 0 : sum / static_cast<double>(count); }
+        std::size_t period() const { return window.size(); }
+
+        void clear()
+        {
+            std::fill(window.begin(), window.end(), 0.0);
+            next = 0;
+            count = 0;
+            sum = 0;
+        }
+
+    private:
+        std::vector<double> window;
+        std::size_t next;
+        std::size_t count;
+        double sum;
+};
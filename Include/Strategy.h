@@ -0,0 +1,23 @@
+#pragma once
+
+#include "MarketView.h"
+#include "OrderBookEntry.h"
+#include "OrderGateway.h"
+#include "Wallet.h"
+
+/** A trading strategy driven by ReplayEngine.
+ * Orders it places through the gateway belong to the simuser, whose sales
+ * are settled into the replay's wallet.
+ */
+class Strategy
+{
+    public:
+        virtual ~Strategy() = default;
+
+        /** called at every tick, before the tick is matched. orders placed
+         * here take part in this tick's matching */
+        virtual void onTick(const MarketView& market, const Wallet& wallet, OrderGateway& orders) = 0;
+        /** called for every sale of one of the strategy's orders, after the
+         * wallet has been updated. sale.id is the order that traded */
+        virtual void onFill(const OrderBookEntry& /*sale*/, OrderGateway& /*orders*/) {}
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "OrderBook.h"
+#include "Strategy.h"
+#include "ThreadPool.h"
+#include "Wallet.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/** Backtests many strategies, e.g. one per parameter set, over one dataset.
+ * Each run replays its own copy of the book. The copies share the
+ * dataset's orders and only own what their strategy changes, so memory
+ * stays near one dataset however many runs there are.
+ */
+class SweepRunner
+{
+    public:
+        struct Result
+        {
+            std::size_t run = 0;
+            /** change of the wallet's value, in the quote currency */
+            double pnl = 0;
+            /** sales of the strategy's orders */
+            std::size_t trades = 0;
+            /** amount filled over amount submitted, 0 if nothing was submitted */
+            double fillRatio = 0;
+            /** largest fall of the wallet's value from an earlier peak */
+            double maxDrawdown = 0;
+        };
+        /** builds the strategy of run i, e.g. from the i-th parameter set */
+        using StrategyFactory = std::function<std::unique_ptr<Strategy>(std::size_t run)>;
+
+        /** sweep over the orders of book, every run starting with a copy of
+         * wallet. Wallets are valued in quoteCurrency at the dataset's mid
+         * prices, currencies without a pair to it count as 0.
+         * runs are spread over workers threads (0 = one per core) */
+        SweepRunner(const OrderBook& book, const Wallet& wallet, std::string quoteCurrency,
+                    unsigned workers = 0);
+
+        /** backtest runs strategies, results in run order */
+        std::vector<Result> run(std::size_t runs, const StrategyFactory& factory);
+        /** results as a table, one row per run */
+        static void printResults(const std::vector<Result>& results, std::ostream& out);
+
+    private:
+        /** one run, on whichever worker picked it up */
+        Result runOne(std::size_t run, const StrategyFactory& factory) const;
+        /** mid price of every product at every tick of the dataset */
+        void buildMarks();
+        /** index into marks of the latest tick at or before timestamp */
+        std::size_t markIndex(std::int64_t timestamp) const;
+        /** value of wallet in the quote currency at a tick */
+        double value(const Wallet& wallet, std::size_t tick) const;
+
+        const OrderBook& book;
+        Wallet wallet;
+        std::string quote;
+        ThreadPool pool;
+        /** marks[tick][product], products in getKnownProducts() order.
+         * a tick without a price keeps the one before it */
+        std::vector<std::vector<double>> marks;
+        /** currency -> (product, true if the currency is the product's quote side) */
+        std::unordered_map<std::string, std::pair<std::size_t, bool>> pairs;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/** dense id handed out by a SymbolTable */
+using SymbolId = std::uint16_t;
+
+/** Interns strings into dense integer ids.
+ * Ids are handed out in first-seen order and never reused, so comparing
+ * two ids for equality is the same as comparing the strings. Safe to use from the
+ * parallel loader's worker threads.
+ */
+class SymbolTable
+{
+    public:
+        SymbolTable() = default;
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        /** process-wide table of product names, e.g. "ETH/BTC" */
+        static SymbolTable& products();
+        /** process-wide table of order owners, e.g. "dataset" */
+        static SymbolTable& usernames();
+
+        /** id of name, adding it if it is new.
+         * throws std::length_error once every id is taken */
+        SymbolId intern(std::string_view name);
+        /** look name up without adding it */
+        bool find(std::string_view name, SymbolId& id) const;
+        /** the string behind an id handed out by this table */
+        const std::string& name(SymbolId id) const;
+        std::size_t size() const;
+
+    private:
+        mutable std::shared_mutex mutex;
+        // deque keeps the strings in place, so the views used as keys stay valid
+        std::deque<std::string> names;
+        std::unordered_map<std::string_view, SymbolId> ids;
+};
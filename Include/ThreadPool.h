@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Fixed set of worker threads that run batches of independent tasks.
+ * Workers are started once and reused, so handing a batch to the pool
+ * costs a wake-up instead of a thread start per task.
+ */
+class ThreadPool
+{
+    public:
+        /** run batches on workers threads, counting the caller, 0 = one per core.
+         * A pool of 1 starts no threads and runs every batch on the caller */
+        explicit ThreadPool(unsigned workers = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** run task(i) for every i in [0, count) and wait for all of them.
+         * The calling thread works on the batch too. The first exception a
+         * task throws is rethrown here once the batch has finished */
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+        /** threads a batch runs on, the caller included */
+        unsigned size() const { return static_cast<unsigned>(threads.size()) + 1; }
+
+    private:
+        struct Batch;
+
+        void work();
+        /** run tasks of batch until none are left unclaimed */
+        static void drain(Batch& batch);
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Batch*> batches;
+        bool stopping = false;
+};
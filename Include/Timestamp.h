@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** Conversions between the dataset's "YYYY/MM/DD HH:MM:SS.ffffff" strings
+ * and int64 microsecond ticks counted from 1970/01/01 00:00:00.
+ */
+class Timestamp
+{
+    public:
+        /** parse a timestamp, the fraction is optional and may have 0-6 digits.
+         * returns false if the text is not in that shape */
+        static bool parse(std::string_view text, std::int64_t& ticks);
+        /** format ticks as "YYYY/MM/DD HH:MM:SS.ffffff" */
+        static std::string format(std::int64_t ticks);
+
+        static constexpr std::int64_t ticksPerSecond = 1000000;
+};
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <utility>
 #include <iostream>
 
 #include "OrderBookEntry.h"
@@ -16,14 +17,19 @@ class Wallet
         bool removeCurrency(std::string type, double amount);
         
         /** check if the wallet contains this much currency or more */
-        bool containsCurrency(std::string type, double amount);
+        bool containsCurrency(std::string type, double amount) const;
         /** checks if the wallet can cope with this ask or bid.*/
-        bool canFulfillOrder(OrderBookEntry order);
+        bool canFulfillOrder(OrderBookEntry order) const;
         /** update the contents of the wallet
          * assumes the order was made by the owner of the wallet
         */
         void processSale(OrderBookEntry& sale);
 
+        /** every currency held and its amount */
+        const std::map<std::string,double>& getCurrencies() const { return currencies; }
+        /** replace the contents of the wallet, e.g. from a checkpoint */
+        void setCurrencies(std::map<std::string,double> _currencies) { currencies = std::move(_currencies); }
+
         /** generate a string representation of the wallet */
         std::string toString() const;
 
@@ -0,0 +1,95 @@
+// Compares the CSV ingestion paths on a synthetic order book dump.
+//
+//   CSVLoadBench [sizeMB] [maxWorkers]
+//
+// The file is generated once next to the binary and reused on later runs.
+#include "CSVReader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    void writeSyntheticFile(const std::string& filename, std::size_t targetBytes)
+    {
+        const char* products[] = {"ETH/BTC", "DOGE/BTC", "BTC/USDT", "ETH/USDT", "DOGE/USDT"};
+        std::mt19937_64 rng{42};
+        std::uniform_real_distribution<double> price{0.0001, 10000.0};
+        std::uniform_real_distribution<double> amount{0.001, 1000.0};
+
+        std::ofstream out{filename, std::ios::binary};
+        std::size_t written = 0;
+        long long second = 0;
+        char line[128];
+        while (written < targetBytes)
+        {
+            // a few hundred rows share each timestamp, like the real dumps
+            long long s = second++;
+            for (int p = 0; p < 5; ++p)
+            {
+                for (int side = 0; side < 2; ++side)
+                {
+                    for (int i = 0; i < 40; ++i)
+                    {
+                        int n = std::snprintf(line, sizeof(line),
+                            "2020/03/17 %02lld:%02lld:%02lld.884492,%s,%s,%.8f,%.8f\n",
+                            (s / 3600) % 24, (s / 60) % 60, s % 60,
+                            products[p], side == 0 ? "bid" : "ask",
+                            price(rng), amount(rng));
+                        out.write(line, n);
+                        written += static_cast<std::size_t>(n);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename F>
+    double timeIt(F&& f, std::size_t& rows)
+    {
+        auto start = std::chrono::steady_clock::now();
+        rows = f().size();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t sizeMB = argc > 1 ? std::stoul(argv[1]) : 512;
+    unsigned int maxWorkers = argc > 2 ? static_cast<unsigned int>(std::stoul(argv[2]))
+                                       : std::max(1u, std::thread::hardware_concurrency());
+
+    std::string filename = "csvloadbench_" + std::to_string(sizeMB) + "MB.csv";
+    if (!std::ifstream{filename}.good())
+    {
+        std::cout << "Generating " << filename << " ..." << std::endl;
+        writeSyntheticFile(filename, sizeMB << 20);
+    }
+
+    std::size_t rows = 0;
+    double baseline = timeIt([&]() { return CSVReader::readCSV(filename); }, rows);
+    std::cout << "stream (getline)     " << baseline << " s  " << rows << " rows" << std::endl;
+
+    double mapped = timeIt([&]() { return CSVReader::readCSVMapped(filename); }, rows);
+    std::cout << "mapped               " << mapped << " s  x" << baseline / mapped << std::endl;
+
+    // powers of two up to the core count, plus the core count itself
+    std::vector<unsigned int> workerCounts;
+    for (unsigned int w = 1; w < maxWorkers; w *= 2) workerCounts.push_back(w);
+    workerCounts.push_back(maxWorkers);
+
+    for (unsigned int workers : workerCounts)
+    {
+        double t = timeIt([&]() { return CSVReader::readCSVParallel(filename, workers); }, rows);
+        std::cout << "parallel " << workers << " workers" << std::string(workers < 10 ? 3 : 2, ' ')
+                  << t << " s  x" << baseline / t << std::endl;
+    }
+    return 0;
+}
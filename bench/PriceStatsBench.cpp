@@ -0,0 +1,139 @@
+// Micro-benchmark of the price statistics used by the candles.
+//
+//   PriceStatsBench [orders] [products]
+//
+// Times the old high/low/average helpers, one walk over the entries each,
+// against OrderBook::getPriceStats, and the raw column kernel for each
+// instruction set.
+#include "CpuFeatures.h"
+#include "OrderBook.h"
+#include "PriceStats.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // OrderBook::getHighPrice, getLowPrice and getAveragePrice before PriceStats
+    double legacyHigh(OrderRange orders)
+    {
+        double max = orders.front().price;
+        for (const OrderBookEntry& e : orders) if (e.price > max) max = e.price;
+        return max;
+    }
+
+    double legacyLow(OrderRange orders)
+    {
+        double min = orders.front().price;
+        for (const OrderBookEntry& e : orders) if (e.price < min) min = e.price;
+        return min;
+    }
+
+    double legacyAverage(OrderRange orders, SymbolId product)
+    {
+        float sum = 0.0;
+        int count = 0;
+        for (const OrderBookEntry& e : orders)
+        {
+            if (e.product == product)
+            {
+                sum += e.price;
+                count++;
+            }
+        }
+        return sum / count;
+    }
+
+    template <typename F>
+    double timeIt(F&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    const char* isaName(CpuFeatures::Isa isa)
+    {
+        switch (isa)
+        {
+            case CpuFeatures::Isa::avx2: return "avx2";
+            case CpuFeatures::Isa::sse2: return "sse2";
+            default: return "scalar";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t orderCount = argc > 1 ? std::stoul(argv[1]) : 4000000;
+    std::size_t productCount = argc > 2 ? std::stoul(argv[2]) : 5;
+    const int rounds = 10;
+
+    std::vector<SymbolId> products;
+    for (std::size_t p = 0; p < productCount; ++p)
+    {
+        products.push_back(SymbolTable::products().intern("BENCH" + std::to_string(p) + "/USDT"));
+    }
+    std::mt19937_64 rng{7};
+    std::uniform_real_distribution<double> price{5000.0, 5100.0};
+    std::uniform_real_distribution<double> amount{0.001, 2.0};
+    std::vector<OrderBookEntry> orders;
+    std::vector<double> prices;
+    std::vector<double> amounts;
+    orders.reserve(orderCount);
+    for (std::size_t i = 0; i < orderCount; ++i)
+    {
+        orders.emplace_back(price(rng), amount(rng), 0, products[i % productCount], OrderBookType::bid);
+        prices.push_back(orders.back().price);
+        amounts.push_back(orders.back().amount);
+    }
+    const OrderRange view{orders};
+
+    double checksum = 0;
+    double legacy = timeIt([&]()
+    {
+        for (int r = 0; r < rounds; ++r)
+        {
+            for (SymbolId p : products)
+            {
+                checksum += legacyHigh(view) + legacyLow(view) + legacyAverage(view, p);
+            }
+        }
+    });
+    double fused = timeIt([&]()
+    {
+        for (int r = 0; r < rounds; ++r)
+        {
+            for (SymbolId p : products)
+            {
+                PriceStats stats = OrderBook::getPriceStats(view, p);
+                checksum += stats.high + stats.low + stats.mean();
+            }
+        }
+    });
+    std::cout << "high/low/average legacy  " << legacy / rounds << " s" << std::endl;
+    std::cout << "getPriceStats            " << fused / rounds << " s  x" << legacy / fused << std::endl;
+
+    CpuFeatures::Isa best = CpuFeatures::activeIsa();
+    for (CpuFeatures::Isa isa : {CpuFeatures::Isa::scalar, CpuFeatures::Isa::sse2, CpuFeatures::Isa::avx2})
+    {
+        CpuFeatures::forceIsa(isa);
+        if (CpuFeatures::activeIsa() != isa) continue;
+        double t = timeIt([&]()
+        {
+            for (int r = 0; r < rounds; ++r)
+            {
+                checksum += PriceStats::compute(prices.data(), amounts.data(), prices.size()).vwap();
+            }
+        });
+        std::cout << "columns " << isaName(isa) << std::string(7 - std::string(isaName(isa)).size(), ' ')
+                  << t / rounds << " s  " << orderCount * rounds / t / 1e6 << " M orders/s" << std::endl;
+    }
+    CpuFeatures::forceIsa(best);
+
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Micro-benchmark of the CSV tokenizer.
+//
+//   TokeniseBench [lines]
+//
+// Times the old find_first_of/substr tokenise against the scanner based
+// one, and the raw delimiter scan for each instruction set.
+#include "CSVReader.h"
+#include "CSVScanner.h"
+#include "CpuFeatures.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // CSVReader::tokenise before it was moved onto CSVScanner
+    std::vector<std::string> legacyTokenise(std::string csvLine, char separator)
+    {
+        std::vector<std::string> tokens;
+        signed int start, end;
+        std::string token;
+        start = csvLine.find_first_not_of(separator, 0);
+        do{
+            end = csvLine.find_first_of(separator, start);
+            if (start == static_cast<signed int>(csvLine.length()) || start == end) break;
+            if (end >= 0) token = csvLine.substr(start, end - start);
+            else token = csvLine.substr(start, csvLine.length() - start);
+            tokens.push_back(token);
+            start = end + 1;
+        }while(end > 0);
+        return tokens;
+    }
+
+    template <typename F>
+    double timeIt(F&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    const char* isaName(CpuFeatures::Isa isa)
+    {
+        switch (isa)
+        {
+            case CpuFeatures::Isa::avx2: return "avx2";
+            case CpuFeatures::Isa::sse2: return "sse2";
+            default: return "scalar";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t lineCount = argc > 1 ? std::stoul(argv[1]) : 2000000;
+
+    std::mt19937_64 rng{7};
+    std::uniform_real_distribution<double> price{0.0001, 10000.0};
+    std::vector<std::string> lines;
+    std::string text;
+    lines.reserve(lineCount);
+    char buffer[128];
+    for (std::size_t i = 0; i < lineCount; ++i)
+    {
+        std::snprintf(buffer, sizeof(buffer), "2020/03/17 17:01:24.884492,ETH/BTC,%s,%.8f,%.8f",
+                      i % 2 ? "bid" : "ask", price(rng), price(rng));
+        lines.emplace_back(buffer);
+        text += lines.back();
+        text += '\n';
+    }
+
+    std::size_t checksum = 0;
+    double legacy = timeIt([&]()
+    {
+        for (const std::string& line : lines) checksum += legacyTokenise(line, ',').size();
+    });
+    double current = timeIt([&]()
+    {
+        for (const std::string& line : lines) checksum += CSVReader::tokenise(line, ',').size();
+    });
+    std::cout << "tokenise legacy   " << legacy << " s" << std::endl;
+    std::cout << "tokenise scanner  " << current << " s  x" << legacy / current << std::endl;
+
+    CpuFeatures::Isa best = CpuFeatures::activeIsa();
+    std::vector<std::uint32_t> offsets;
+    for (CpuFeatures::Isa isa : {CpuFeatures::Isa::scalar, CpuFeatures::Isa::sse2, CpuFeatures::Isa::avx2})
+    {
+        CpuFeatures::forceIsa(isa);
+        if (CpuFeatures::activeIsa() != isa) continue;
+        double t = timeIt([&]()
+        {
+            offsets.clear();
+            CSVScanner::findDelimiters(text.data(), text.size(), ',', offsets);
+        });
+        checksum += offsets.size();
+        std::cout << "scan " << isaName(isa) << std::string(7 - std::string(isaName(isa)).size(), ' ')
+                  << t << " s  " << text.size() / t / (1 << 20) << " MB/s" << std::endl;
+    }
+    CpuFeatures::forceIsa(best);
+
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
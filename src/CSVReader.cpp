@@ -1,6 +1,20 @@
 #include "CSVReader.h"
+#include "MappedFile.h"
+#include "CSVScanner.h"
+#include "Timestamp.h"
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <charconv>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 CSVReader::CSVReader()
 {
@@ -22,15 +36,17 @@ std::vector<OrderBookEntry> CSVReader::readCSV(std::string csvFilename)
         while(std::getline(csvFile, line))
         {
             lineLocation++;
-            try {
-                OrderBookEntry obe = stringsToOBE(tokenise(line, ','));
-                entries.push_back(obe);
-            }catch(const std::exception& e)
+            std::vector<std::string> tokens = tokenise(line, ',');
+            std::string_view fields[5];
+            for (std::size_t i = 0; i < tokens.size() && i < 5; ++i) fields[i] = tokens[i];
+            // bad lines are skipped, the status only says why
+            ParseStatus status = fieldsToOBE(fields, tokens.size(), entries);
+            if (status != ParseStatus::ok)
             {
                 if(look == 1) std::cout << "CSVReader::readCSV - Line: " << 
-                lineLocation << " has bad data, causing the error: " << e.what() << std::endl;
-                //skip the iteration and continue with the next line
-                continue;
+                lineLocation << " has bad data: " <<
+                (status == ParseStatus::badFieldCount ? "bad line" :
+                 status == ParseStatus::badNumber ? "bad float" : "bad timestamp") << std::endl;
             }
         }// end of while
     }    
@@ -41,52 +57,278 @@ std::vector<OrderBookEntry> CSVReader::readCSV(std::string csvFilename)
     return entries; 
 }
 
-std::vector<std::string> CSVReader::tokenise(std::string csvLine, char separator)
+std::vector<OrderBookEntry> CSVReader::readCSV(std::string csvFilename, ReadMode mode)
 {
-   std::vector<std::string> tokens;
-   signed int start, end;
-   std::string token;
-    start = csvLine.find_first_not_of(separator, 0);
-    do{
-        end = csvLine.find_first_of(separator, start);
-        if (start == csvLine.length() || start == end) break;
-        if (end >= 0) token = csvLine.substr(start, end - start);
-        else token = csvLine.substr(start, csvLine.length() - start);
-        tokens.push_back(token);
-    start = end + 1;
-    }while(end > 0);
+    if (mode == ReadMode::mapped) return readCSVMapped(csvFilename);
+    if (mode == ReadMode::parallel) return readCSVParallel(csvFilename);
+    return readCSV(csvFilename);
+}
 
-   return tokens; 
+std::vector<OrderBookEntry> CSVReader::readCSVMapped(const std::string& csvFilename)
+{
+    std::vector<OrderBookEntry> entries;
+
+    MappedFile csvFile{csvFilename};
+    if (!csvFile.isOpen()) return entries;
+
+    // rough guess of the row count so the vector does not keep regrowing
+    entries.reserve(csvFile.size() / 64);
+    parseLines(csvFile.view(), entries);
+
+    return entries;
+}
+
+std::vector<OrderBookEntry> CSVReader::readCSVParallel(const std::string& csvFilename, unsigned int workers)
+{
+    MappedFile csvFile{csvFilename};
+    if (!csvFile.isOpen()) return std::vector<OrderBookEntry>{};
+
+    const std::string_view text = csvFile.view();
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    // below this a chunk is not worth a thread of its own
+    const std::size_t minChunkSize = 1 << 20;
+    workers = static_cast<unsigned int>(std::min<std::size_t>(workers, text.size() / minChunkSize + 1));
+
+    // cut the file into roughly equal chunks, each boundary pushed
+    // forward to just after the next newline so no line is split
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    for (unsigned int i = 1; i <= workers && begin < text.size(); ++i)
+    {
+        std::size_t end = text.size();
+        if (i < workers)
+        {
+            std::size_t target = std::max(begin, text.size() / workers * i);
+            std::size_t newline = text.find('\n', target);
+            end = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    std::vector<std::vector<OrderBookEntry>> results(chunks.size());
+    std::vector<std::thread> threads;
+    threads.reserve(chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        threads.emplace_back([&chunks, &results, i]()
+        {
+            results[i].reserve(chunks[i].size() / 64);
+            parseLines(chunks[i], results[i]);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+
+    // chunks are consecutive slices of the file, so appending them in
+    // chunk order gives back exactly the serial reader's order
+    std::size_t total = 0;
+    for (const auto& r : results) total += r.size();
+    std::vector<OrderBookEntry> entries;
+    if (results.empty()) return entries;
+    entries = std::move(results[0]);
+    entries.reserve(total);
+    for (std::size_t i = 1; i < results.size(); ++i)
+    {
+        entries.insert(entries.end(),
+                       std::make_move_iterator(results[i].begin()),
+                       std::make_move_iterator(results[i].end()));
+    }
+    return entries;
+}
+
+void CSVReader::parseLines(std::string_view text, std::vector<OrderBookEntry>& entries)
+{
+    // to display the bad line make it 1
+    int look = 0;
+
+    // offsets of every ',' and '\n' in the current block, found by the SIMD scanner
+    std::vector<std::uint32_t> offsets;
+    std::size_t blockSize = 1 << 16;
+    std::size_t pos = 0;
+    int lineLocation = 0;
+    while (pos < text.size())
+    {
+        const std::size_t length = std::min(blockSize, text.size() - pos);
+        const bool lastBlock = pos + length == text.size();
+        const char* block = text.data() + pos;
+        offsets.clear();
+        CSVScanner::findDelimiters(block, length, ',', offsets);
+
+        std::size_t lineStart = 0;
+        std::size_t firstSep = 0;
+        for (std::size_t i = 0; i <= offsets.size(); ++i)
+        {
+            std::size_t lineEnd;
+            if (i < offsets.size())
+            {
+                if (block[offsets[i]] != '\n') continue;
+                lineEnd = offsets[i];
+            }
+            else
+            {
+                // unterminated text at the end of the file is still a line
+                if (!lastBlock || lineStart >= length) break;
+                lineEnd = length;
+            }
+            lineLocation++;
+            // same line content std::getline would hand to tokenise
+            std::string_view line{block + lineStart, lineEnd - lineStart};
+            if (!parseLine(line, offsets.data() + firstSep, i - firstSep,
+                           static_cast<std::uint32_t>(lineStart), entries))
+            {
+                if(look == 1) std::cout << "CSVReader::parseLines - Line: " <<
+                lineLocation << " has bad data" << std::endl;
+            }
+            lineStart = lineEnd + 1;
+            firstSep = i + 1;
+        }
+
+        if (lastBlock) break;
+        if (lineStart == 0)
+        {
+            // a single line longer than the block, retry with a bigger one
+            blockSize *= 2;
+            continue;
+        }
+        // the cut-off line at the end of the block starts the next one
+        pos += lineStart;
+    }
+    if(look==1) {std::cout << "CSVReader::parseLines read " << entries.size() << " entries"  <<
+    std::endl;}
+}
+
+bool CSVReader::parseLine(std::string_view line, const std::uint32_t* seps, std::size_t sepCount,
+                          std::uint32_t base, std::vector<OrderBookEntry>& entries)
+{
+    std::string_view fields[5];
+    std::size_t count = 0;
+
+    // same field rules as tokenise: leading separators are skipped and an
+    // empty field ends the line, so ",,"-style rows come out short
+    std::size_t seen = CSVScanner::forEachField(line, seps, sepCount, base, [&](std::string_view field)
+    {
+        if (count == 5) return false;
+        fields[count++] = field;
+        return true;
+    });
+    return fieldsToOBE(fields, seen, entries) == ParseStatus::ok;
 }
 
-OrderBookEntry CSVReader::stringsToOBE(std::vector<std::string> tokens)
+CSVReader::ParseStatus CSVReader::fieldsToOBE(const std::string_view* fields, std::size_t count,
+                                              std::vector<OrderBookEntry>& entries)
 {
+    if (count != 5) return ParseStatus::badFieldCount;
+
     double price, amount;
+    if (!parseDouble(fields[3], price) || !parseDouble(fields[4], amount))
+    {
+        return ParseStatus::badNumber;
+    }
+    std::int64_t timestamp;
+    if (!Timestamp::parse(fields[0], timestamp))
+    {
+        return ParseStatus::badTimestamp;
+    }
 
-    if (tokens.size() != 5) // bad
+    // rows come in long runs of one product, remember the last lookup
+    thread_local std::string lastProduct;
+    thread_local SymbolId lastProductId = 0;
+    if (lastProduct.empty() || fields[1] != lastProduct)
     {
-        std::cout << "Bad line " << std::endl;
-        throw std::exception{};
+        lastProductId = SymbolTable::products().intern(fields[1]);
+        lastProduct.assign(fields[1]);
     }
-    // we have 5 tokens
-    try {
-         price = std::stod(tokens[3]);
-         amount = std::stod(tokens[4]);
-    }catch(const std::exception& e){
-        std::cout << "CSVReader::stringsToOBE Bad float! " << tokens[3]<< std::endl;
-        std::cout << "CSVReader::stringsToOBE Bad float! " << tokens[4]<< std::endl; 
-        throw;        
+
+    entries.emplace_back(price,
+                         amount,
+                         timestamp,
+                         lastProductId,
+                         OrderBookEntry::stringToOrderBookType(fields[2]));
+    return ParseStatus::ok;
+}
+
+bool CSVReader::parseDouble(std::string_view text, double& value)
+{
+    // std::stod skips leading white space and accepts a '+' sign,
+    // std::from_chars does neither
+    std::size_t pos = 0;
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-'))
+    {
+        negative = text[pos] == '-';
+        ++pos;
     }
+    // only one sign, "+-1" is as bad for stod as it is here
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) return false;
 
-    OrderBookEntry obe{price, 
-                        amount, 
-                        tokens[0],
-                        tokens[1], 
-                        OrderBookEntry::stringToOrderBookType(tokens[2])};
+    const char* first = text.data() + pos;
+    const char* last = text.data() + text.size();
+    double parsed = 0.0;
 
-    return obe; 
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto isHexDigit = [last](const char* c) { return c < last && std::isxdigit(static_cast<unsigned char>(*c)); };
+    if (last - first > 1 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+    {
+        // stod also reads hex floats, "0x" without hex digits after it
+        // reads as the leading 0
+        const char* digits = first + 2;
+        if (isHexDigit(digits) || (digits < last && *digits == '.' && isHexDigit(digits + 1)))
+        {
+            if (std::from_chars(digits, last, parsed, std::chars_format::hex).ec != std::errc{}) return false;
+        }
+    }
+    // no digits at all, or out of range: both made stod throw
+    else if (std::from_chars(first, last, parsed).ec != std::errc{})
+    {
+        return false;
+    }
+    // strtod flags subnormal results as a range error too
+    if (parsed != 0.0 && std::fabs(parsed) < std::numeric_limits<double>::min()) return false;
+    // anything after the number is ignored, as stod does
+#else
+    // no floating point from_chars in this standard library, strtod
+    // reports errors through errno and endptr instead of throwing
+    char buffer[64];
+    std::string longText;
+    const char* cText;
+    std::size_t length = static_cast<std::size_t>(last - first);
+    if (length < sizeof(buffer))
+    {
+        std::memcpy(buffer, first, length);
+        buffer[length] = '\0';
+        cText = buffer;
+    }
+    else
+    {
+        longText.assign(first, length);
+        cText = longText.c_str();
+    }
+    char* end = nullptr;
+    errno = 0;
+    parsed = std::strtod(cText, &end);
+    if (end == cText || errno == ERANGE) return false;
+#endif
+
+    value = negative ? -parsed : parsed;
+    return true;
 }
 
+std::vector<std::string> CSVReader::tokenise(std::string csvLine, char separator)
+{
+    std::vector<std::string> tokens;
+    // reused between calls, tokenise runs for every line and every wallet check
+    thread_local std::vector<std::uint32_t> seps;
+    seps.clear();
+    CSVScanner::findChar(csvLine.data(), csvLine.size(), separator, seps);
+    CSVScanner::forEachField(csvLine, seps.data(), seps.size(), 0, [&tokens](std::string_view field)
+    {
+        tokens.emplace_back(field);
+        return true;
+    });
+
+   return tokens; 
+}
 
 OrderBookEntry CSVReader::stringsToOBE(std::string priceString, 
                                     std::string amountString, 
@@ -95,13 +337,11 @@ OrderBookEntry CSVReader::stringsToOBE(std::string priceString,
                                     OrderBookType orderType)
 {
     double price, amount;
-    try {
-         price = std::stod(priceString);
-         amount = std::stod(amountString);
-    }catch(const std::exception& e){
+    if (!parseDouble(priceString, price) || !parseDouble(amountString, amount))
+    {
         std::cout << "CSVReader::stringsToOBE Bad float! " << priceString<< std::endl;
         std::cout << "CSVReader::stringsToOBE Bad float! " << amountString<< std::endl; 
-        throw;        
+        throw std::invalid_argument{"CSVReader::stringsToOBE bad float"};
     }
     OrderBookEntry obe{price, 
                     amount, 
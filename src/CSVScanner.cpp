@@ -0,0 +1,107 @@
+#include "CSVScanner.h"
+#include "CpuFeatures.h"
+
+#ifdef CPUFEATURES_X86
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    /** index of the lowest set bit, mask must not be 0 */
+    inline unsigned int lowestBit(std::uint32_t mask)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned int>(index);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+
+    inline void emitMask(std::uint32_t mask, std::size_t base, std::vector<std::uint32_t>& offsets)
+    {
+        while (mask != 0)
+        {
+            offsets.push_back(static_cast<std::uint32_t>(base + lowestBit(mask)));
+            mask &= mask - 1;
+        }
+    }
+
+    void scanScalar(const char* data, std::size_t size, char a, char b, std::size_t from,
+                    std::vector<std::uint32_t>& offsets)
+    {
+        for (std::size_t i = from; i < size; ++i)
+        {
+            if (data[i] == a || data[i] == b) offsets.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+#ifdef CPUFEATURES_X86
+    void scanSSE2(const char* data, std::size_t size, char a, char b,
+                  std::vector<std::uint32_t>& offsets)
+    {
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        std::size_t i = 0;
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+            emitMask(static_cast<std::uint32_t>(_mm_movemask_epi8(hits)), i, offsets);
+        }
+        scanScalar(data, size, a, b, i, offsets);
+    }
+
+    CPUFEATURES_TARGET_AVX2
+    void scanAVX2(const char* data, std::size_t size, char a, char b,
+                  std::vector<std::uint32_t>& offsets)
+    {
+        const __m256i va = _mm256_set1_epi8(a);
+        const __m256i vb = _mm256_set1_epi8(b);
+        std::size_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb));
+            emitMask(static_cast<std::uint32_t>(_mm256_movemask_epi8(hits)), i, offsets);
+        }
+        scanScalar(data, size, a, b, i, offsets);
+    }
+#endif
+
+    void scan(const char* data, std::size_t size, char a, char b, std::vector<std::uint32_t>& offsets)
+    {
+        // every field ends in a delimiter, so a fifth of the bytes is a fair guess
+        offsets.reserve(offsets.size() + size / 5);
+        switch (CpuFeatures::activeIsa())
+        {
+#ifdef CPUFEATURES_X86
+            case CpuFeatures::Isa::avx2:
+                scanAVX2(data, size, a, b, offsets);
+                return;
+            case CpuFeatures::Isa::sse2:
+                scanSSE2(data, size, a, b, offsets);
+                return;
+#endif
+            default:
+                scanScalar(data, size, a, b, 0, offsets);
+                return;
+        }
+    }
+}
+
+void CSVScanner::findDelimiters(const char* data, std::size_t size, char separator,
+                                std::vector<std::uint32_t>& offsets)
+{
+    scan(data, size, separator, '\n', offsets);
+}
+
+void CSVScanner::findChar(const char* data, std::size_t size, char c,
+                          std::vector<std::uint32_t>& offsets)
+{
+    scan(data, size, c, c, offsets);
+}
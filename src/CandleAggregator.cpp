@@ -0,0 +1,134 @@
+#include "CandleAggregator.h"
+#include <algorithm>
+
+namespace
+{
+    const std::vector<Candle> noCandles;
+}
+
+CandleAggregator::CandleAggregator(std::int64_t _interval)
+: interval{std::max<std::int64_t>(_interval, 1)}, capacity{0}
+{
+
+}
+
+Candle* CandleAggregator::liveCandle(Series& s, std::int64_t timestamp, double firstPrice)
+{
+    // floor, so timestamps before 1970 still land in the right interval
+    std::int64_t start = timestamp / interval * interval;
+    if (start > timestamp) start -= interval;
+
+    if (s.hasLive)
+    {
+        if (start == s.live.start) return &s.live;
+        if (start < s.live.start) return nullptr;
+        s.closed.push_back(s.live);
+        if (capacity != 0 && s.closed.size() >= 2 * capacity)
+        {
+            s.closed.erase(s.closed.begin(), s.closed.end() - static_cast<std::ptrdiff_t>(capacity));
+        }
+    }
+    // carry on from the last close, the first candle opens at its first price
+    const double open = s.hasLive ? s.live.close : firstPrice;
+    s.live = Candle{start, open, open, open, open, 0, 0};
+    s.hasLive = true;
+    return &s.live;
+}
+
+bool CandleAggregator::add(SymbolId product, std::int64_t timestamp, double price, double amount)
+{
+    Series& s = series[product];
+    Candle* candle = liveCandle(s, timestamp, price);
+    if (!candle) return false;
+    candle->high = std::max(candle->high, price);
+    candle->low = std::min(candle->low, price);
+    candle->close = price;
+    candle->volume += amount;
+    ++candle->events;
+    ++s.version;
+    return true;
+}
+
+bool CandleAggregator::add(const OrderBookEntry& entry)
+{
+    return add(entry.product, entry.timestamp, entry.price, entry.amount);
+}
+
+bool CandleAggregator::add(SymbolId product, std::int64_t timestamp, const PriceStats& stats)
+{
+    if (stats.count == 0) return false;
+    Series& s = series[product];
+    Candle* candle = liveCandle(s, timestamp, stats.mean());
+    if (!candle) return false;
+    candle->high = std::max(candle->high, stats.high);
+    candle->low = std::min(candle->low, stats.low);
+    candle->close = stats.mean();
+    candle->volume += stats.volume;
+    candle->events += stats.count;
+    ++s.version;
+    return true;
+}
+
+bool CandleAggregator::add(SymbolId product, const Candle& candle)
+{
+    Series& s = series[product];
+    Candle* live = liveCandle(s, candle.start, candle.open);
+    if (!live) return false;
+    live->high = std::max(live->high, candle.high);
+    live->low = std::min(live->low, candle.low);
+    live->close = candle.close;
+    live->volume += candle.volume;
+    live->events += candle.events;
+    ++s.version;
+    return true;
+}
+
+void CandleAggregator::setCapacity(std::size_t _capacity)
+{
+    capacity = _capacity;
+    if (capacity == 0) return;
+    for (auto& s : series)
+    {
+        std::vector<Candle>& closed = s.second.closed;
+        if (closed.size() <= capacity) continue;
+        closed.erase(closed.begin(), closed.end() - static_cast<std::ptrdiff_t>(capacity));
+        ++s.second.version;
+    }
+}
+
+const std::vector<Candle>& CandleAggregator::getClosed(SymbolId product) const
+{
+    auto found = series.find(product);
+    return found == series.end() ? noCandles : found->second.closed;
+}
+
+const Candle* CandleAggregator::getLive(SymbolId product) const
+{
+    auto found = series.find(product);
+    if (found == series.end() || !found->second.hasLive) return nullptr;
+    return &found->second.live;
+}
+
+std::vector<Candle> CandleAggregator::getCandles(SymbolId product) const
+{
+    std::vector<Candle> candles = getClosed(product);
+    if (const Candle* live = getLive(product)) candles.push_back(*live);
+    return candles;
+}
+
+std::uint64_t CandleAggregator::getVersion(SymbolId product) const
+{
+    auto found = series.find(product);
+    return found == series.end() ? 0 : found->second.version;
+}
+
+void CandleAggregator::clear()
+{
+    // versions keep counting, so a cached copy never looks current again
+    for (auto& s : series)
+    {
+        s.second.closed.clear();
+        s.second.hasLive = false;
+        ++s.second.version;
+    }
+}
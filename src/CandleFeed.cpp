@@ -0,0 +1,57 @@
+#include "CandleFeed.h"
+#include <algorithm>
+
+CandleFeed::CandleFeed(const OrderBook& _book, std::vector<std::int64_t> intervals)
+: book{_book}, pyramid{std::move(intervals)}, cursor{0}, read{false}
+{
+
+}
+
+void CandleFeed::advance(std::int64_t timestamp)
+{
+    if (read && timestamp < cursor)
+    {
+        pyramid.clear();
+        read = false;
+    }
+    const std::vector<std::int64_t>& timeline = book.getTimeline();
+    auto from = read ? std::upper_bound(timeline.begin(), timeline.end(), cursor) : timeline.begin();
+    auto to = std::upper_bound(from, timeline.end(), timestamp);
+    for (auto tick = from; tick != to; ++tick)
+    {
+        for (const std::string& name : book.getKnownProducts())
+        {
+            SymbolId product;
+            if (!SymbolTable::products().find(name, product)) continue;
+            // the quotes of both sides make up the tick's price range
+            PriceStats stats = OrderBook::getPriceStats(book.getOrders(OrderBookType::ask, product, *tick), product);
+            stats.merge(OrderBook::getPriceStats(book.getOrders(OrderBookType::bid, product, *tick), product));
+            pyramid.add(product, *tick, stats);
+        }
+        cursor = *tick;
+        read = true;
+    }
+}
+
+std::size_t CandleFeed::levelForSpan(std::int64_t span, std::size_t maxCandles) const
+{
+    const std::int64_t most = static_cast<std::int64_t>(std::max<std::size_t>(maxCandles, 1));
+    for (std::size_t level = 0; level < pyramid.levelCount(); ++level)
+    {
+        if (span / pyramid.getInterval(level) <= most) return level;
+    }
+    return pyramid.levelCount() - 1;
+}
+
+const std::vector<Candle>& CandleFeed::getCandles(SymbolId product, std::size_t level)
+{
+    Cached& cached = cache[{product, level}];
+    const std::uint64_t version = pyramid.getVersion(product);
+    if (!cached.valid || cached.version != version)
+    {
+        cached.candles = pyramid.getCandles(product, level);
+        cached.version = version;
+        cached.valid = true;
+    }
+    return cached.candles;
+}
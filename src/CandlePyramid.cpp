@@ -0,0 +1,91 @@
+#include "CandlePyramid.h"
+#include "Timestamp.h"
+#include <iostream>
+
+std::vector<std::int64_t> CandlePyramid::defaultIntervals()
+{
+    const std::int64_t second = Timestamp::ticksPerSecond;
+    return {second, 60 * second, 5 * 60 * second, 60 * 60 * second, 24 * 60 * 60 * second};
+}
+
+CandlePyramid::CandlePyramid(std::vector<std::int64_t> intervals, std::size_t capacity)
+{
+    for (std::int64_t interval : intervals)
+    {
+        // a candle of one level must fall wholly within a candle of the next
+        const std::int64_t finer = levels.empty() ? 1 : levels.back().getInterval();
+        if (interval <= 0 || (!levels.empty() && interval == finer) || interval % finer != 0)
+        {
+            std::cout << "CandlePyramid - skipping interval " << interval << std::endl;
+            continue;
+        }
+        levels.emplace_back(interval);
+        levels.back().setCapacity(capacity);
+    }
+    if (levels.empty()) levels.emplace_back(1);
+}
+
+bool CandlePyramid::add(SymbolId product, std::int64_t timestamp, double price, double amount)
+{
+    const Candle* live = levels.front().getLive(product);
+    const bool hadLive = live != nullptr;
+    const std::int64_t start = hadLive ? live->start : 0;
+    if (!levels.front().add(product, timestamp, price, amount)) return false;
+    rollUp(product, start, hadLive);
+    return true;
+}
+
+bool CandlePyramid::add(const OrderBookEntry& entry)
+{
+    return add(entry.product, entry.timestamp, entry.price, entry.amount);
+}
+
+bool CandlePyramid::add(SymbolId product, std::int64_t timestamp, const PriceStats& stats)
+{
+    const Candle* live = levels.front().getLive(product);
+    const bool hadLive = live != nullptr;
+    const std::int64_t start = hadLive ? live->start : 0;
+    if (!levels.front().add(product, timestamp, stats)) return false;
+    rollUp(product, start, hadLive);
+    return true;
+}
+
+void CandlePyramid::rollUp(SymbolId product, std::int64_t previousStart, bool hadLive)
+{
+    for (std::size_t level = 0; hadLive && level + 1 < levels.size(); ++level)
+    {
+        // still the same candle, nothing closed here or above
+        if (levels[level].getLive(product)->start == previousStart) return;
+        const Candle closed = levels[level].getClosed(product).back();
+        const Candle* above = levels[level + 1].getLive(product);
+        hadLive = above != nullptr;
+        previousStart = hadLive ? above->start : 0;
+        levels[level + 1].add(product, closed);
+    }
+}
+
+std::size_t CandlePyramid::levelFor(std::int64_t interval) const
+{
+    std::size_t level = 0;
+    while (level + 1 < levels.size() && levels[level + 1].getInterval() <= interval) ++level;
+    return level;
+}
+
+std::vector<Candle> CandlePyramid::getCandles(SymbolId product, std::size_t level) const
+{
+    std::vector<Candle> candles = levels[level].getClosed(product);
+    // the live candles of this level and the finer ones, oldest first, have
+    // not been handed up yet
+    CandleAggregator recent{levels[level].getInterval()};
+    for (std::size_t l = level + 1; l-- > 0; )
+    {
+        if (const Candle* live = levels[l].getLive(product)) recent.add(product, *live);
+    }
+    for (const Candle& candle : recent.getCandles(product)) candles.push_back(candle);
+    return candles;
+}
+
+void CandlePyramid::clear()
+{
+    for (CandleAggregator& level : levels) level.clear();
+}
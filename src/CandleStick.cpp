@@ -1,5 +1,6 @@
 #include "CandleStick.h"
 #include "CSVReader.h"
+#include "Timestamp.h"
 #include <map>
 #include <iostream>
 #include <fstream>
@@ -16,7 +17,7 @@ CandleStick::CandleStick()
 
 };
 
-std::string CandleStick::filterTimestamp(std::string& timestamp)
+std::string CandleStick::filterTimestamp(const std::string& timestamp)
 {
     // Parse the timestamp
     std::istringstream fTime(timestamp);
@@ -46,47 +47,10 @@ std::string CandleStick::filterTimestamp(std::string& timestamp)
     return foTime.str();
 }
 
-std::map<std::string, std::vector<Candlestick>> CandleStick::calculateCandlestickDetails(OrderBook& orderBook, std::string& timestamp, OrderBookType orderType, 
-std::vector<OrderBookEntry>& selectedOrders) {
-    /** String variable to hold timestamp of current order */
-    std::string time = CandleStick::filterTimestamp(timestamp);
-    /** Vector to storing key(product)>Value(time, openValue, closeValue, highestValue, lowestValue) */
-    std::map<std::string, std::vector<Candlestick>> candlesticksByProduct;
-
-    // Handling unselected products
-    if (selectedOrders.empty()) {
-        return candlesticksByProduct; // Return an empty map
-    }
-
-    // Iterate through selected order and perform calculations
-    for (const auto& order : selectedOrders) {
-        // Use the product from the order
-        std::string product = order.product;
-
-        // Check if data for the product has already been stored
-        if (candlesticksByProduct.find(product) == candlesticksByProduct.end()) {
-                // Create a new vector to selected product to store found data
-                candlesticksByProduct[product] = std::vector<Candlestick>();
-                // Calculate highest and lowest values for the product
-                double highestValue = orderBook.getHighPrice(selectedOrders, product);
-                double lowestValue = orderBook.getLowPrice(selectedOrders, product);
-
-                // Check if there is a previous close value for the product
-                double openValue = 0.0;
-                if (!candlesticksByProduct[product].empty()) {
-                    // Use the close value of the last candlestick as the open value for the current candlestick
-                    openValue = candlesticksByProduct[product].back().close;
-                }
-                // Use the current timestamp's average price as the close value
-                double closeValue = orderBook.getAveragePrice(selectedOrders, product); 
-
-                // Create a Candlestick instance and add it to the vector for the specific product
-                Candlestick candlestick = {time, openValue, closeValue, highestValue, lowestValue};
-                // push the object associated with product into the vector
-                candlesticksByProduct[product].push_back(candlestick);
-            }
-        }
-    return candlesticksByProduct;
+Candlestick CandleStick::toCandlestick(const Candle& candle)
+{
+    return Candlestick{filterTimestamp(Timestamp::format(candle.start)),
+                       candle.open, candle.close, candle.high, candle.low};
 }
 
 void CandleStick::printColoredCandle(const std::string& textColor, const std::string& backgroundColor, const std::string& text) {
@@ -17,8 +17,8 @@
 #include <QDebug>
 #include <algorithm>
 #include <numeric>
-#include <cstdlib>
-#include <ctime>
+#include "RollingMean.h"
+#include "Timestamp.h"
 #include <QtCharts/QBarSeries>
 #include <QtCharts/QBarSet>
 #include <QtCharts/QBarCategoryAxis>
@@ -39,8 +39,14 @@ CandlestickChart::CandlestickChart(QWidget *parent)
     , volumeSeries(new QLineSeries())
     , ma20Series(new QLineSeries())
     , ma50Series(new QLineSeries())
+    , drawn(false)
+    , drawnDays(0)
+    , drawnProduct(0)
+    , drawnLevel(0)
+    , drawnVersion(0)
+    , ma20(20)
+    , ma50(50)
 {
-    std::srand(std::time(nullptr));
     setupUI();
     setupChart();
     connectSignals();
@@ -48,7 +54,8 @@ CandlestickChart::CandlestickChart(QWidget *parent)
 
 CandlestickChart::~CandlestickChart()
 {
-    // Destructor implementation
+    // sets on the series are deleted with it, pooled ones belong to us
+    qDeleteAll(setPool);
 }
 
 void CandlestickChart::setupUI()
@@ -152,88 +159,186 @@ void CandlestickChart::connectSignals()
 void CandlestickChart::setOrderBook(OrderBook *book)
 {
     orderBook = book;
+    feed = book ? std::make_unique<CandleFeed>(*book) : nullptr;
+    drawn = false;
     updateChart(currentTime);
 }
 
-void CandlestickChart::updateChart(const std::string& currentTime)
+void CandlestickChart::updateChart(const std::string& time)
 {
-    if (!orderBook) {
+    if (!orderBook || !feed) {
         qDebug() << "OrderBook not set";
         return;
     }
-    
-    // Clear existing data
-    candlestickSeries->clear();
-    ma20Series->clear();
-    ma50Series->clear();
-    
-    // Get all timestamps for the product
-    std::vector<std::string> timestamps = orderBook->getKnownTimestamps(selectedProduct);
-    
-    if (timestamps.empty()) {
-        qDebug() << "No timestamps available";
+    currentTime = time;
+
+    // Read the ticks up to the current time, so the chart follows the replay
+    std::int64_t now;
+    if (Timestamp::parse(currentTime, now)) {
+        feed->advance(now);
+    }
+
+    SymbolId product;
+    if (!SymbolTable::products().find(selectedProduct, product)) {
+        qDebug() << "Unknown product" << currentProduct;
         return;
     }
-    
-    // Limit to timeframe
-    int maxPoints = std::min(timeframeDays * 24, static_cast<int>(timestamps.size()));
-    std::vector<std::string> limitedTimestamps(timestamps.end() - maxPoints, timestamps.end());
-    
-    std::vector<double> closePrices;
-    
-    for (const std::string &timestamp : limitedTimestamps) {
-        // Get candlestick data for this timestamp
-        // Mock candlestick data for demonstration
-        Candlestick candleData;
-        candleData.timestamp = timestamp;
-        candleData.open = 100.0 + (rand() % 20);
-        candleData.high = candleData.open + (rand() % 10);
-        candleData.low = candleData.open - (rand() % 10);
-        candleData.close = candleData.low + (rand() % static_cast<int>(candleData.high - candleData.low));
-        // candleData.volume = 1000 + (rand() % 5000); // Volume not used in this struct
-        
-        if (candleData.open > 0) { // Valid data
-            QDateTime dateTime = QDateTime::fromString(QString::fromStdString(timestamp), "yyyy/MM/dd hh:mm:ss");
-            
-            // Create candlestick set
-            QCandlestickSet *candleSet = new QCandlestickSet(dateTime.toMSecsSinceEpoch());
-            candleSet->setOpen(candleData.open);
-            candleSet->setHigh(candleData.high);
-            candleSet->setLow(candleData.low);
-            candleSet->setClose(candleData.close);
-            
-            candlestickSeries->append(candleSet);
-            closePrices.push_back(candleData.close);
-            
-            // Calculate moving averages
-            if (closePrices.size() >= 20) {
-                double ma20 = 0;
-                for (int i = closePrices.size() - 20; i < closePrices.size(); ++i) {
-                    ma20 += closePrices[i];
-                }
-                ma20 /= 20;
-                ma20Series->append(dateTime.toMSecsSinceEpoch(), ma20);
-            }
-            
-            if (closePrices.size() >= 50) {
-                double ma50 = 0;
-                for (int i = closePrices.size() - 50; i < closePrices.size(); ++i) {
-                    ma50 += closePrices[i];
-                }
-                ma50 /= 50;
-                ma50Series->append(dateTime.toMSecsSinceEpoch(), ma50);
-            }
+
+    // The timeframe picks the candle interval, e.g. 5 minute candles for a day
+    const std::int64_t span = timeframeDays * 24LL * 60 * 60 * Timestamp::ticksPerSecond;
+    const std::size_t level = feed->levelForSpan(span, MAX_CANDLES);
+    const std::uint64_t version = feed->getVersion(product);
+    const bool sameSelection = drawn && drawnDays == timeframeDays && drawnProduct == product
+        && drawnLevel == level;
+    if (sameSelection && drawnVersion == version) {
+        return; // no new ticks since the last refresh
+    }
+    const std::vector<Candle>& candles = feed->getCandles(product, level);
+    // Only the timeframe is drawn
+    const std::int64_t from = candles.empty() ? 0 : candles.back().start - span;
+
+    // Same selection with new ticks: the newest shown candle may have moved on,
+    // anything after it is new. Everything else needs a full redraw
+    auto last = shownCandles.empty() ? candles.end()
+        : std::lower_bound(candles.begin(), candles.end(), shownCandles.back().start,
+                           [](const Candle &c, std::int64_t t) { return c.start < t; });
+    if (sameSelection && last != candles.end() && last->start == shownCandles.back().start) {
+        replaceLastCandle(*last);
+        for (auto candle = last + 1; candle != candles.end(); ++candle) {
+            appendCandle(*candle);
         }
+        trimCandlesBefore(from);
+    } else {
+        redrawCandles(candles, from);
     }
-    
+    drawn = true;
+    drawnDays = timeframeDays;
+    drawnProduct = product;
+    drawnLevel = level;
+    drawnVersion = version;
+
     // Update chart title
     chart->setTitle("Candlestick Chart - " + currentProduct + " (" + QString::number(timeframeDays) + " days)");
-    
-    // Auto-scale axes
+    rescaleAxes();
+}
+
+void CandlestickChart::redrawCandles(const std::vector<Candle>& candles, std::int64_t from)
+{
+    // hand the sets back to the pool instead of letting clear() delete them
+    for (QCandlestickSet *set : shownSets) {
+        candlestickSeries->take(set);
+        setPool.push_back(set);
+    }
+    shownSets.clear();
+    shownCandles.clear();
+    ma20Series->clear();
+    ma50Series->clear();
+    ma20.clear();
+    ma50.clear();
+
+    for (const Candle &candle : candles) {
+        if (candle.start < from) {
+            // the averages start from the earlier candles too
+            ma20.push(candle.close);
+            ma50.push(candle.close);
+            continue;
+        }
+        appendCandle(candle);
+    }
+}
+
+QCandlestickSet* CandlestickChart::takeSet(const Candle& candle)
+{
+    const qint64 msecs = candle.start / 1000;
+    if (setPool.empty()) {
+        return new QCandlestickSet(candle.open, candle.high, candle.low, candle.close, msecs);
+    }
+    QCandlestickSet *set = setPool.back();
+    setPool.pop_back();
+    set->setTimestamp(msecs);
+    set->setOpen(candle.open);
+    set->setHigh(candle.high);
+    set->setLow(candle.low);
+    set->setClose(candle.close);
+    return set;
+}
+
+void CandlestickChart::appendCandle(const Candle& candle)
+{
+    QCandlestickSet *set = takeSet(candle);
+    candlestickSeries->append(set);
+    shownSets.push_back(set);
+    shownCandles.push_back(candle);
+
+    const qint64 msecs = candle.start / 1000;
+    ma20.push(candle.close);
+    ma50.push(candle.close);
+    if (ma20.ready()) {
+        ma20Series->append(msecs, ma20.value());
+    }
+    if (ma50.ready()) {
+        ma50Series->append(msecs, ma50.value());
+    }
+}
+
+void CandlestickChart::replaceLastCandle(const Candle& candle)
+{
+    QCandlestickSet *set = shownSets.back();
+    set->setOpen(candle.open);
+    set->setHigh(candle.high);
+    set->setLow(candle.low);
+    set->setClose(candle.close);
+    shownCandles.back() = candle;
+
+    // the last average point belongs to this candle
+    const qint64 msecs = candle.start / 1000;
+    ma20.replaceLast(candle.close);
+    ma50.replaceLast(candle.close);
+    if (ma20.ready() && ma20Series->count() > 0) {
+        ma20Series->replace(ma20Series->count() - 1, msecs, ma20.value());
+    }
+    if (ma50.ready() && ma50Series->count() > 0) {
+        ma50Series->replace(ma50Series->count() - 1, msecs, ma50.value());
+    }
+}
+
+void CandlestickChart::trimCandlesBefore(std::int64_t from)
+{
+    while (!shownCandles.empty() && shownCandles.front().start < from) {
+        candlestickSeries->take(shownSets.front());
+        setPool.push_back(shownSets.front());
+        shownSets.pop_front();
+        shownCandles.pop_front();
+    }
+
+    const qreal fromMsecs = from / 1000;
+    for (QLineSeries *series : {ma20Series, ma50Series}) {
+        int count = 0;
+        while (count < series->count() && series->at(count).x() < fromMsecs) {
+            ++count;
+        }
+        if (count > 0) {
+            series->removePoints(0, count);
+        }
+    }
+}
+
+void CandlestickChart::rescaleAxes()
+{
+    if (shownCandles.empty()) {
+        return;
+    }
+    minPrice = shownCandles.front().low;
+    maxPrice = shownCandles.front().high;
+    for (const Candle &candle : shownCandles) {
+        minPrice = std::min(minPrice, candle.low);
+        maxPrice = std::max(maxPrice, candle.high);
+    }
     chart->axes(Qt::Horizontal).first()->setRange(
-        QDateTime::fromString(QString::fromStdString(limitedTimestamps.front()), "yyyy/MM/dd hh:mm:ss"),
-        QDateTime::fromString(QString::fromStdString(limitedTimestamps.back()), "yyyy/MM/dd hh:mm:ss")
+        QDateTime::fromMSecsSinceEpoch(shownCandles.front().start / 1000),
+        QDateTime::fromMSecsSinceEpoch((shownCandles.back().start + feed->getPyramid().getInterval(drawnLevel)) / 1000)
     );
+    chart->axes(Qt::Vertical).first()->setRange(minPrice, maxPrice);
 }
 
 void CandlestickChart::onProductChanged(const QString &product)
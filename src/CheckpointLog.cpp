@@ -0,0 +1,396 @@
+#include "CheckpointLog.h"
+#include "OrderBook.h"
+#include "ReplayEngine.h"
+#include "SymbolTable.h"
+#include "Wallet.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    const char logMagic[8] = {'O', 'B', 'C', 'K', 'L', 'O', 'G', '\0'};
+    const std::uint32_t byteOrderMark = 0x01020304;
+    const std::int64_t finishedCursor = std::numeric_limits<std::int64_t>::max();
+
+    /** serialises a checkpoint. products and usernames are written as
+     * indices into name tables of the record, since SymbolIds depend on
+     * the order a process interned its names in */
+    class Writer
+    {
+        public:
+            template <typename T>
+            void put(T value)
+            {
+                const char* p = reinterpret_cast<const char*>(&value);
+                body.insert(body.end(), p, p + sizeof(T));
+            }
+            void putString(const std::string& s)
+            {
+                put(static_cast<std::uint32_t>(s.size()));
+                body.insert(body.end(), s.begin(), s.end());
+            }
+            void putProduct(SymbolId id) { put(local(products, productIndex, id)); }
+            void putUser(SymbolId id) { put(local(users, userIndex, id)); }
+            void putEntry(const OrderBookEntry& e)
+            {
+                put(e.price);
+                put(e.amount);
+                put(e.timestamp);
+                put(e.id);
+                putProduct(e.product);
+                putUser(e.username);
+                put(static_cast<std::uint8_t>(e.orderType));
+                put(static_cast<std::uint8_t>(e.kind));
+            }
+            void putEntries(const std::vector<OrderBookEntry>& entries)
+            {
+                put(static_cast<std::uint32_t>(entries.size()));
+                for (const OrderBookEntry& e : entries) putEntry(e);
+            }
+
+            /** name tables, then the body */
+            std::vector<char> finish() const
+            {
+                Writer out;
+                for (const std::vector<SymbolId>* table : {&products, &users})
+                {
+                    const SymbolTable& names = table == &products ? SymbolTable::products()
+                                                                  : SymbolTable::usernames();
+                    out.put(static_cast<std::uint32_t>(table->size()));
+                    for (SymbolId id : *table) out.putString(names.name(id));
+                }
+                out.body.insert(out.body.end(), body.begin(), body.end());
+                return out.body;
+            }
+
+        private:
+            static std::uint16_t local(std::vector<SymbolId>& table,
+                                       std::unordered_map<SymbolId, std::uint16_t>& index, SymbolId id)
+            {
+                auto found = index.find(id);
+                if (found != index.end()) return found->second;
+                std::uint16_t i = static_cast<std::uint16_t>(table.size());
+                table.push_back(id);
+                index.emplace(id, i);
+                return i;
+            }
+
+            std::vector<char> body;
+            std::vector<SymbolId> products;
+            std::vector<SymbolId> users;
+            std::unordered_map<SymbolId, std::uint16_t> productIndex;
+            std::unordered_map<SymbolId, std::uint16_t> userIndex;
+    };
+
+    /** reads what Writer wrote, every get fails once the data runs out */
+    class Reader
+    {
+        public:
+            Reader(const char* _data, std::size_t _size) : data{_data}, size{_size}, pos{0} {}
+
+            template <typename T>
+            bool get(T& value)
+            {
+                if (size - pos < sizeof(T)) return false;
+                std::memcpy(&value, data + pos, sizeof(T));
+                pos += sizeof(T);
+                return true;
+            }
+            bool getString(std::string& s)
+            {
+                std::uint32_t length;
+                if (!get(length) || size - pos < length) return false;
+                s.assign(data + pos, length);
+                pos += length;
+                return true;
+            }
+            bool getNames()
+            {
+                for (std::vector<SymbolId>* table : {&products, &users})
+                {
+                    SymbolTable& names = table == &products ? SymbolTable::products() : SymbolTable::usernames();
+                    std::uint32_t count;
+                    if (!get(count)) return false;
+                    std::string name;
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        if (!getString(name)) return false;
+                        table->push_back(names.intern(name));
+                    }
+                }
+                return true;
+            }
+            bool getProduct(SymbolId& id) { return global(products, id); }
+            bool getUser(SymbolId& id) { return global(users, id); }
+            bool getEntry(OrderBookEntry& e)
+            {
+                std::uint8_t type;
+                std::uint8_t kind;
+                if (!(get(e.price) && get(e.amount) && get(e.timestamp) && get(e.id) &&
+                      getProduct(e.product) && getUser(e.username) && get(type) && get(kind)))
+                {
+                    return false;
+                }
+                e.orderType = static_cast<OrderBookType>(type);
+                e.kind = static_cast<OrderKind>(kind);
+                return true;
+            }
+            bool getEntries(std::vector<OrderBookEntry>& entries)
+            {
+                // price, amount, timestamp, id, product, user, side and kind
+                const std::size_t entryBytes = 4 * sizeof(std::uint64_t) + 2 * sizeof(std::uint16_t)
+                                             + 2 * sizeof(std::uint8_t);
+                std::uint32_t count;
+                if (!get(count)) return false;
+                // a corrupt count must fail here, not ask reserve for gigabytes
+                if (count > (size - pos) / entryBytes) return false;
+                entries.reserve(count);
+                for (std::uint32_t i = 0; i < count; ++i)
+                {
+                    OrderBookEntry e{0, 0, 0, 0, OrderBookType::unknown};
+                    if (!getEntry(e)) return false;
+                    entries.push_back(e);
+                }
+                return true;
+            }
+
+        private:
+            bool global(const std::vector<SymbolId>& table, SymbolId& id)
+            {
+                std::uint16_t i;
+                if (!get(i) || i >= table.size()) return false;
+                id = table[i];
+                return true;
+            }
+
+            const char* data;
+            std::size_t size;
+            std::size_t pos;
+            std::vector<SymbolId> products;
+            std::vector<SymbolId> users;
+    };
+}
+
+CheckpointLog::CheckpointLog(std::string _filename)
+: filename{std::move(_filename)}, valid{true}, end{0}
+{
+    std::error_code error;
+    if (std::filesystem::exists(filename, error)) valid = index();
+}
+
+bool CheckpointLog::index()
+{
+    std::ifstream in{filename, std::ios::binary};
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, logMagic, sizeof(logMagic)) != 0 ||
+        header.version != formatVersion || header.byteOrder != byteOrderMark)
+    {
+        return false;
+    }
+
+    std::error_code error;
+    const std::uint64_t fileSize = std::filesystem::file_size(filename, error);
+    if (error) return false;
+    std::uint64_t offset = sizeof(FileHeader);
+    RecordHeader record;
+    while (in.seekg(static_cast<std::streamoff>(offset)) &&
+           in.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        std::uint64_t payload = offset + sizeof(RecordHeader);
+        if (record.size > fileSize - payload) break;
+        records.push_back(Record{payload, record.size, record.cursor});
+        offset = payload + record.size;
+    }
+    end = offset;
+    // a crash while appending leaves a torn record, later appends go over it
+    if (end < fileSize) std::filesystem::resize_file(filename, end, error);
+    return !error;
+}
+
+std::vector<std::int64_t> CheckpointLog::getCursors() const
+{
+    std::vector<std::int64_t> cursors;
+    cursors.reserve(records.size());
+    for (const Record& r : records) cursors.push_back(r.cursor);
+    return cursors;
+}
+
+bool CheckpointLog::append(const ReplayEngine& replay)
+{
+    if (!valid) return false;
+    const OrderBook& book = replay.getBook();
+    OrderBook::State state = book.getState();
+    const std::int64_t cursor = replay.finished() ? finishedCursor : replay.getCurrentTick();
+    // from the cursor on only the orders still to be matched and the open
+    // ones, which can be cancelled or amended, make a difference. Keeping
+    // every order ever inserted would make each record bigger than the last
+    std::unordered_set<OrderId> open;
+    for (const OrderBookEntry& order : state.open) open.insert(order.id);
+    state.inserted.erase(std::remove_if(state.inserted.begin(), state.inserted.end(),
+                                        [&](const OrderBookEntry& order)
+                                        {
+                                            return order.timestamp < cursor && open.count(order.id) == 0;
+                                        }),
+                         state.inserted.end());
+
+    Writer out;
+    out.put(static_cast<std::uint8_t>(state.matchMode));
+    out.putEntries(state.inserted);
+    out.putEntries(state.open);
+    out.put(static_cast<std::uint32_t>(state.liveBooks.size()));
+    for (const OrderBook::State::Live& live : state.liveBooks)
+    {
+        out.putProduct(live.product);
+        out.putEntries(live.resting);
+        out.put(static_cast<std::uint32_t>(live.levels.size()));
+        for (const LiveBook::Level& level : live.levels)
+        {
+            out.put(static_cast<std::uint8_t>(level.side));
+            out.put(level.price);
+            out.put(level.amount);
+        }
+    }
+    out.put(static_cast<std::uint32_t>(state.pendingFills.size()));
+    for (const auto& pending : state.pendingFills)
+    {
+        out.putProduct(pending.first);
+        out.put(static_cast<std::uint32_t>(pending.second.size()));
+        for (const LimitOrderBook::Fill& fill : pending.second)
+        {
+            out.put(fill.price);
+            out.put(fill.amount);
+            out.put(fill.timestamp);
+            out.putProduct(fill.product);
+            out.putUser(fill.buyer);
+            out.putUser(fill.seller);
+            out.put(static_cast<std::uint8_t>(fill.takerSide));
+            out.put(fill.takerId);
+            out.put(fill.makerId);
+        }
+    }
+    const std::map<std::string, double>& currencies = replay.getWallet().getCurrencies();
+    out.put(static_cast<std::uint32_t>(currencies.size()));
+    for (const auto& held : currencies)
+    {
+        out.putString(held.first);
+        out.put(held.second);
+    }
+    std::vector<char> payload = out.finish();
+
+    std::ofstream file{filename, std::ios::binary | std::ios::app};
+    if (!file) return false;
+    if (end == 0)
+    {
+        FileHeader header;
+        std::memcpy(header.magic, logMagic, sizeof(logMagic));
+        header.version = formatVersion;
+        header.byteOrder = byteOrderMark;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        end = sizeof(header);
+    }
+    RecordHeader header{payload.size(), cursor};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    file.flush();
+    if (!file) return false;
+
+    records.push_back(Record{end + sizeof(RecordHeader), payload.size(), header.cursor});
+    end += sizeof(RecordHeader) + payload.size();
+    return true;
+}
+
+bool CheckpointLog::restore(std::size_t i, ReplayEngine& replay) const
+{
+    if (!valid || i >= records.size()) return false;
+    const Record& record = records[i];
+    std::vector<char> payload(record.size);
+    std::ifstream file{filename, std::ios::binary};
+    if (!file.seekg(static_cast<std::streamoff>(record.offset)) ||
+        !file.read(payload.data(), static_cast<std::streamsize>(payload.size())))
+    {
+        return false;
+    }
+
+    // read everything before touching the replay, so a bad record changes nothing
+    Reader in{payload.data(), payload.size()};
+    OrderBook::State state;
+    std::uint8_t mode;
+    std::uint32_t count;
+    if (!in.getNames() || !in.get(mode) || !in.getEntries(state.inserted) || !in.getEntries(state.open) ||
+        !in.get(count))
+    {
+        return false;
+    }
+    state.matchMode = static_cast<MatchMode>(mode);
+    for (std::uint32_t b = 0; b < count; ++b)
+    {
+        OrderBook::State::Live live;
+        std::uint32_t levels;
+        if (!in.getProduct(live.product) || !in.getEntries(live.resting) || !in.get(levels)) return false;
+        for (std::uint32_t l = 0; l < levels; ++l)
+        {
+            std::uint8_t side;
+            LiveBook::Level level;
+            if (!in.get(side) || !in.get(level.price) || !in.get(level.amount)) return false;
+            level.side = static_cast<OrderBookType>(side);
+            live.levels.push_back(level);
+        }
+        state.liveBooks.push_back(std::move(live));
+    }
+    if (!in.get(count)) return false;
+    for (std::uint32_t p = 0; p < count; ++p)
+    {
+        SymbolId product;
+        std::uint32_t fills;
+        if (!in.getProduct(product) || !in.get(fills)) return false;
+        std::vector<LimitOrderBook::Fill> pending;
+        for (std::uint32_t f = 0; f < fills; ++f)
+        {
+            LimitOrderBook::Fill fill;
+            std::uint8_t side;
+            if (!(in.get(fill.price) && in.get(fill.amount) && in.get(fill.timestamp) &&
+                  in.getProduct(fill.product) && in.getUser(fill.buyer) && in.getUser(fill.seller) &&
+                  in.get(side) && in.get(fill.takerId) && in.get(fill.makerId)))
+            {
+                return false;
+            }
+            fill.takerSide = static_cast<OrderBookType>(side);
+            pending.push_back(fill);
+        }
+        state.pendingFills.emplace_back(product, std::move(pending));
+    }
+    std::map<std::string, double> currencies;
+    if (!in.get(count)) return false;
+    for (std::uint32_t c = 0; c < count; ++c)
+    {
+        std::string currency;
+        double amount;
+        if (!in.getString(currency) || !in.get(amount)) return false;
+        currencies[currency] = amount;
+    }
+
+    // seek first, it loads the day the checkpoint was taken in
+    replay.seek(record.cursor);
+    replay.getBook().setState(state);
+    replay.getWallet().setCurrencies(std::move(currencies));
+    return true;
+}
+
+bool CheckpointLog::seek(std::int64_t timestamp, ReplayEngine& replay) const
+{
+    // the log may hold several passes over the data, the latest one wins ties
+    std::size_t best = records.size();
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        if (records[i].cursor > timestamp) continue;
+        if (best == records.size() || records[i].cursor >= records[best].cursor) best = i;
+    }
+    return best != records.size() && restore(best, replay);
+}
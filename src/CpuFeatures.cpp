@@ -0,0 +1,58 @@
+#include "CpuFeatures.h"
+#include <atomic>
+
+#if defined(CPUFEATURES_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace
+{
+#ifdef CPUFEATURES_X86
+    bool cpuHasAVX2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        // the OS must also save the ymm registers (OSXSAVE + XCR0)
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    std::atomic<CpuFeatures::Isa>& currentIsa()
+    {
+        static std::atomic<CpuFeatures::Isa> isa{CpuFeatures::detectIsa()};
+        return isa;
+    }
+}
+
+CpuFeatures::Isa CpuFeatures::detectIsa()
+{
+#ifdef CPUFEATURES_X86
+    if (cpuHasAVX2()) return Isa::avx2;
+    return Isa::sse2;
+#else
+    return Isa::scalar;
+#endif
+}
+
+CpuFeatures::Isa CpuFeatures::activeIsa()
+{
+    return currentIsa().load(std::memory_order_relaxed);
+}
+
+void CpuFeatures::forceIsa(Isa isa)
+{
+    Isa best = detectIsa();
+    // never pick something wider than the CPU can run
+    if (static_cast<int>(isa) > static_cast<int>(best)) isa = best;
+    currentIsa().store(isa);
+}
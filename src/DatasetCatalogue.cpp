@@ -0,0 +1,139 @@
+#include "DatasetCatalogue.h"
+#include "MappedFile.h"
+#include "OrderBookSnapshot.h"
+#include "Timestamp.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    /** midnight of the day a file is named after, e.g. 20200317.csv */
+    bool dayFromName(const std::string& path, std::int64_t& start)
+    {
+        const std::string stem = std::filesystem::path{path}.stem().string();
+        if (stem.size() != 8 ||
+            !std::all_of(stem.begin(), stem.end(), [](unsigned char c) { return std::isdigit(c) != 0; }))
+        {
+            return false;
+        }
+        return Timestamp::parse(stem.substr(0, 4) + "/" + stem.substr(4, 2) + "/" + stem.substr(6, 2) + " 00:00:00",
+                                start);
+    }
+}
+
+DatasetCatalogue::DatasetCatalogue(const std::string& directory, std::size_t _retain)
+: retain{_retain}
+{
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator{directory, error})
+    {
+        const std::string extension = file.path().extension().string();
+        if (!file.is_regular_file() || (extension != ".csv" && extension != ".obsnap")) continue;
+        Day day{file.path().string(), 0, 0};
+        if (readRange(day.path, day.first, day.last)) days.push_back(day);
+    }
+    if (error) std::cout << "DatasetCatalogue - cannot read " << directory << std::endl;
+
+    std::sort(days.begin(), days.end(), [](const Day& a, const Day& b) { return a.first < b.first; });
+    // e.g. a csv next to the snapshot made from it
+    auto overlapping = [](const Day& before, const Day& day) { return day.first <= before.last; };
+    for (std::size_t i = 1; i < days.size(); )
+    {
+        if (overlapping(days[i - 1], days[i]))
+        {
+            std::cout << "DatasetCatalogue - skipping " << days[i].path << ", it overlaps "
+                      << days[i - 1].path << std::endl;
+            days.erase(days.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+        else ++i;
+    }
+}
+
+bool DatasetCatalogue::readRange(const std::string& path, std::int64_t& first, std::int64_t& last)
+{
+    // a file named by day covers that day, so it need not be read yet
+    if (dayFromName(path, first))
+    {
+        last = first + 24 * 60 * 60 * Timestamp::ticksPerSecond - 1;
+        return true;
+    }
+
+    if (OrderBookSnapshot::isSnapshot(path))
+    {
+        OrderBookSnapshot snapshot{path};
+        if (!snapshot.isOpen() || snapshot.size() == 0) return false;
+        auto range = std::minmax_element(snapshot.timestamps(), snapshot.timestamps() + snapshot.size());
+        first = *range.first;
+        last = *range.second;
+        return true;
+    }
+
+    // rows are not in time order within a file, so every timestamp is read.
+    // Only the first field of each row is parsed, straight off the mapping
+    MappedFile file{path};
+    if (!file.isOpen()) return false;
+    std::string_view text = file.view();
+    bool found = false;
+    while (!text.empty())
+    {
+        std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        std::int64_t ticks;
+        // a header row or a blank line does not parse and is skipped
+        if (!Timestamp::parse(line.substr(0, line.find(',')), ticks)) continue;
+        if (!found || ticks < first) first = ticks;
+        if (!found || ticks > last) last = ticks;
+        found = true;
+    }
+    return found;
+}
+
+bool DatasetCatalogue::seek(OrderBook& book, std::int64_t timestamp)
+{
+    auto day = std::lower_bound(days.begin(), days.end(), timestamp,
+                                [](const Day& d, std::int64_t t) { return d.last < t; });
+    if (day == days.end()) return false;
+    return show(book, static_cast<std::size_t>(day - days.begin()));
+}
+
+bool DatasetCatalogue::loadNext(OrderBook& book, std::int64_t timestamp)
+{
+    auto day = std::upper_bound(days.begin(), days.end(), timestamp,
+                                [](std::int64_t t, const Day& d) { return t < d.first; });
+    if (day == days.end()) return false;
+    return show(book, static_cast<std::size_t>(day - days.begin()));
+}
+
+bool DatasetCatalogue::show(OrderBook& book, std::size_t i)
+{
+    while (i < days.size())
+    {
+        const std::size_t from = i > retain ? i - retain : 0;
+        // unload first, so the window never holds more than it should
+        for (std::size_t d = 0; d < days.size(); ++d)
+        {
+            if (d < from || d > i) book.unloadDatasets(days[d].first, days[d].last);
+        }
+        std::vector<std::pair<std::int64_t, std::int64_t>> loaded = book.getDatasetRanges();
+        std::size_t bad = days.size();
+        for (std::size_t d = from; d <= i && bad == days.size(); ++d)
+        {
+            bool isLoaded = std::any_of(loaded.begin(), loaded.end(), [&](const auto& range)
+            {
+                return range.first >= days[d].first && range.second <= days[d].last;
+            });
+            if (!isLoaded && !book.loadDataset(days[d].path)) bad = d;
+        }
+        if (bad == days.size()) return true;
+
+        // e.g. a file removed or damaged since it was indexed, the replay goes on without it
+        std::cout << "DatasetCatalogue - cannot load " << days[bad].path << ", skipping it" << std::endl;
+        days.erase(days.begin() + static_cast<std::ptrdiff_t>(bad));
+        // keep i on the same day, or on the one after a bad day i
+        if (bad < i) --i;
+    }
+    return false;
+}
@@ -0,0 +1,299 @@
+#include "LimitOrderBook.h"
+#include <algorithm>
+
+LimitOrderBook::LimitOrderBook(SymbolId _product)
+: product(_product)
+{
+
+}
+
+LimitOrderBook::LimitOrderBook(const LimitOrderBook& other)
+: product(other.product), bids(other.bids), asks(other.asks)
+{
+    relocate(bids);
+    relocate(asks);
+}
+
+LimitOrderBook& LimitOrderBook::operator=(const LimitOrderBook& other)
+{
+    if (this == &other) return *this;
+    product = other.product;
+    bids = other.bids;
+    asks = other.asks;
+    locators.clear();
+    relocate(bids);
+    relocate(asks);
+    return *this;
+}
+
+template <typename Levels>
+void LimitOrderBook::relocate(Levels& levels)
+{
+    for (auto& level : levels)
+    {
+        Queue& queue = level.second.orders;
+        for (auto it = queue.begin(); it != queue.end(); ++it)
+        {
+            locators[it->id] = Locator{&level.second, it};
+        }
+    }
+}
+
+double LimitOrderBook::submit(const OrderBookEntry& order, std::vector<Fill>& fills)
+{
+    OrderBookEntry incoming = order;
+    if (incoming.id == 0) incoming.id = OrderBookEntry::newId();
+    // an order can only rest once, resubmitting it is a no-op
+    else if (locators.count(incoming.id) != 0) return 0;
+    if (incoming.kind == OrderKind::fok)
+    {
+        // short by no more than a rounding remainder still fills: match
+        // treats that remainder as filled
+        const double missing = incoming.amount - available(incoming.orderType, incoming.price, incoming.amount);
+        if (missing > 0 && !isDust(missing, incoming.amount)) return 0;
+    }
+
+    const bool anyPrice = incoming.kind == OrderKind::market;
+    const bool rests = incoming.kind == OrderKind::limit;
+    double traded = 0;
+    if (incoming.orderType == OrderBookType::bid)
+    {
+        traded = match(asks, incoming, [&](double levelPrice) { return anyPrice || levelPrice <= incoming.price; }, fills);
+        if (rests && incoming.amount > 0) rest(bids, incoming);
+    }
+    else if (incoming.orderType == OrderBookType::ask)
+    {
+        traded = match(bids, incoming, [&](double levelPrice) { return anyPrice || levelPrice >= incoming.price; }, fills);
+        if (rests && incoming.amount > 0) rest(asks, incoming);
+    }
+    return traded;
+}
+
+double LimitOrderBook::available(OrderBookType side, double limit, double wanted) const
+{
+    if (side == OrderBookType::bid)
+    {
+        return sumLevels(asks, [&](double levelPrice) { return levelPrice <= limit; }, wanted);
+    }
+    if (side == OrderBookType::ask)
+    {
+        return sumLevels(bids, [&](double levelPrice) { return levelPrice >= limit; }, wanted);
+    }
+    return 0;
+}
+
+template <typename Levels, typename Crosses>
+double LimitOrderBook::sumLevels(const Levels& levels, Crosses crosses, double wanted)
+{
+    // the queued amounts, not the level totals, which drift by rounding
+    // as orders are filled and amended
+    double sum = 0;
+    for (auto it = levels.begin(); it != levels.end() && sum < wanted && crosses(it->first); ++it)
+    {
+        for (auto order = it->second.orders.begin(); order != it->second.orders.end() && sum < wanted; ++order)
+        {
+            sum += order->amount;
+        }
+    }
+    return sum;
+}
+
+template <typename Levels, typename Crosses>
+double LimitOrderBook::match(Levels& levels, OrderBookEntry& order, Crosses crosses, std::vector<Fill>& fills)
+{
+    const double size = order.amount;
+    double traded = 0;
+    while (order.amount > 0 && !levels.empty() && crosses(levels.begin()->first))
+    {
+        Level& level = levels.begin()->second;
+        OrderBookEntry& resting = level.orders.front();
+        double amount = std::min(order.amount, resting.amount);
+
+        bool buying = order.orderType == OrderBookType::bid;
+        fills.push_back(Fill{resting.price, amount, order.timestamp, product,
+                             buying ? order.username : resting.username,
+                             buying ? resting.username : order.username,
+                             order.orderType, order.id, resting.id});
+
+        const double offered = resting.amount;
+        order.amount -= amount;
+        resting.amount -= amount;
+        traded += amount;
+        // a rounding remainder is not an order, it would only trade as dust
+        if (isDust(order.amount, size)) order.amount = 0;
+        if (isDust(resting.amount, offered))
+        {
+            locators.erase(resting.id);
+            level.orders.pop_front();
+            // the level goes with its last order, whatever its total says
+            if (level.orders.empty()) levels.erase(levels.begin());
+            else level.total -= offered;
+        }
+        else
+        {
+            level.total -= amount;
+        }
+    }
+    return traded;
+}
+
+template <typename Levels>
+void LimitOrderBook::rest(Levels& levels, const OrderBookEntry& order)
+{
+    Level& level = levels[order.price];
+    level.orders.push_back(order);
+    level.total += order.amount;
+    locators[order.id] = Locator{&level, std::prev(level.orders.end())};
+}
+
+double LimitOrderBook::reduce(OrderBookType side, double price, double amount, SymbolId owner)
+{
+    if (side == OrderBookType::bid) return reduceLevel(bids, price, amount, owner);
+    if (side == OrderBookType::ask) return reduceLevel(asks, price, amount, owner);
+    return 0;
+}
+
+template <typename Levels>
+double LimitOrderBook::reduceLevel(Levels& levels, double price, double amount, SymbolId owner)
+{
+    auto found = levels.find(price);
+    if (found == levels.end()) return 0;
+    Level& level = found->second;
+
+    double removed = 0;
+    for (auto it = level.orders.end(); it != level.orders.begin() && !isDust(amount - removed, amount); )
+    {
+        --it;
+        if (it->username != owner) continue;
+        const double before = it->amount;
+        double take = std::min(before, amount - removed);
+        it->amount -= take;
+        removed += take;
+        if (isDust(it->amount, before))
+        {
+            level.total -= before;
+            locators.erase(it->id);
+            it = level.orders.erase(it);
+        }
+        else
+        {
+            level.total -= take;
+        }
+    }
+    if (level.orders.empty()) levels.erase(found);
+    return removed;
+}
+
+void LimitOrderBook::remove(const Locator& at)
+{
+    Level* level = at.level;
+    OrderBookType side = at.order->orderType;
+    double price = at.order->price;
+    level->total -= at.order->amount;
+    level->orders.erase(at.order);
+    if (level->orders.empty())
+    {
+        if (side == OrderBookType::bid) bids.erase(price);
+        else asks.erase(price);
+    }
+}
+
+bool LimitOrderBook::cancel(OrderId id)
+{
+    auto found = locators.find(id);
+    if (found == locators.end()) return false;
+    remove(found->second);
+    locators.erase(found);
+    return true;
+}
+
+bool LimitOrderBook::amend(OrderId id, double amount)
+{
+    auto found = locators.find(id);
+    if (found == locators.end()) return false;
+    Locator& at = found->second;
+    OrderBookEntry& order = *at.order;
+    if (isDust(amount, order.amount)) return cancel(id);
+
+    at.level->total += amount - order.amount;
+    if (amount > order.amount)
+    {
+        // more size queues behind everyone already waiting at the price
+        at.level->orders.splice(at.level->orders.end(), at.level->orders, at.order);
+    }
+    order.amount = amount;
+    return true;
+}
+
+bool LimitOrderBook::amend(OrderId id, double price, double amount, std::vector<Fill>& fills)
+{
+    auto found = locators.find(id);
+    if (found == locators.end()) return false;
+    OrderBookEntry order = *found->second.order;
+    remove(found->second);
+    locators.erase(found);
+
+    const bool resubmit = !isDust(amount, order.amount);
+    order.price = price;
+    order.amount = amount;
+    if (resubmit) submit(order, fills);
+    return true;
+}
+
+const OrderBookEntry* LimitOrderBook::find(OrderId id) const
+{
+    auto found = locators.find(id);
+    return found == locators.end() ? nullptr : &*found->second.order;
+}
+
+bool LimitOrderBook::bestBid(double& price) const
+{
+    if (bids.empty()) return false;
+    price = bids.begin()->first;
+    return true;
+}
+
+bool LimitOrderBook::bestAsk(double& price) const
+{
+    if (asks.empty()) return false;
+    price = asks.begin()->first;
+    return true;
+}
+
+double LimitOrderBook::amountAt(OrderBookType side, double price) const
+{
+    if (side == OrderBookType::bid)
+    {
+        auto it = bids.find(price);
+        return it == bids.end() ? 0 : it->second.total;
+    }
+    auto it = asks.find(price);
+    return it == asks.end() ? 0 : it->second.total;
+}
+
+std::size_t LimitOrderBook::levelCount(OrderBookType side) const
+{
+    return side == OrderBookType::bid ? bids.size() : asks.size();
+}
+
+std::vector<OrderBookEntry> LimitOrderBook::getResting() const
+{
+    std::vector<OrderBookEntry> resting;
+    resting.reserve(locators.size());
+    for (const auto& level : bids)
+    {
+        resting.insert(resting.end(), level.second.orders.begin(), level.second.orders.end());
+    }
+    for (const auto& level : asks)
+    {
+        resting.insert(resting.end(), level.second.orders.begin(), level.second.orders.end());
+    }
+    return resting;
+}
+
+void LimitOrderBook::clear()
+{
+    bids.clear();
+    asks.clear();
+    locators.clear();
+}
@@ -0,0 +1,101 @@
+#include "LiveBook.h"
+#include <algorithm>
+
+LiveBook::LiveBook(SymbolId product)
+: book(product)
+{
+
+}
+
+std::vector<LiveBook::Level> LiveBook::getDatasetLevels() const
+{
+    std::vector<Level> levels;
+    levels.reserve(datasetLevels.size());
+    for (const auto& level : datasetLevels)
+    {
+        levels.push_back(Level{level.first.first, level.first.second, level.second});
+    }
+    return levels;
+}
+
+void LiveBook::restore(const std::vector<OrderBookEntry>& resting, const std::vector<Level>& levels)
+{
+    book.clear();
+    // resting orders never cross, so resubmitting them only rests them
+    std::vector<LimitOrderBook::Fill> none;
+    for (const OrderBookEntry& order : resting)
+    {
+        book.submit(order, none);
+    }
+    datasetLevels.clear();
+    for (const Level& level : levels)
+    {
+        datasetLevels.emplace(LevelKey{level.side, level.price}, level.amount);
+    }
+}
+
+void LiveBook::advance(OrderRange asks, OrderRange bids, std::vector<LimitOrderBook::Fill>& fills)
+{
+    const SymbolId dataset = OrderBookEntry::datasetUser();
+
+    std::map<LevelKey, double> levels;
+    std::vector<const OrderBookEntry*> incoming;
+    for (OrderRange side : {asks, bids})
+    {
+        for (const OrderBookEntry& e : side)
+        {
+            if (e.username == dataset) levels[LevelKey{e.orderType, e.price}] += e.amount;
+            else incoming.push_back(&e);
+        }
+    }
+
+    // liquidity that left the market goes first, so nothing trades against it
+    for (const auto& level : datasetLevels)
+    {
+        auto now = levels.find(level.first);
+        double amount = now == levels.end() ? 0 : now->second;
+        // sums that differ only by rounding are the same level
+        if (amount < level.second && !LimitOrderBook::isDust(level.second - amount, level.second))
+        {
+            book.reduce(level.first.first, level.first.second, level.second - amount, dataset);
+        }
+    }
+
+    // liquidity that arrived is submitted like any other order
+    std::vector<OrderBookEntry> added;
+    for (const auto& level : levels)
+    {
+        auto before = datasetLevels.find(level.first);
+        double amount = before == datasetLevels.end() ? 0 : before->second;
+        if (level.second > amount && !LimitOrderBook::isDust(level.second - amount, level.second))
+        {
+            const OrderBookEntry& sample = level.first.first == OrderBookType::ask ? asks.front() : bids.front();
+            added.push_back(OrderBookEntry{level.first.second, level.second - amount, sample.timestamp,
+                                           sample.product, level.first.first, dataset});
+        }
+    }
+    for (const OrderBookEntry& e : added)
+    {
+        incoming.push_back(&e);
+    }
+
+    // limit asks, then limit bids highest first, then market/ioc/fok
+    // orders as placed: the order matchAsksToBids uses
+    auto rank = [](const OrderBookEntry* e)
+    {
+        if (e->kind != OrderKind::limit) return 2;
+        return e->orderType == OrderBookType::ask ? 0 : 1;
+    };
+    std::stable_sort(incoming.begin(), incoming.end(), [&](const OrderBookEntry* a, const OrderBookEntry* b)
+    {
+        if (rank(a) != rank(b)) return rank(a) < rank(b);
+        if (rank(a) == 2) return a->id < b->id;
+        return rank(a) == 1 && a->price > b->price;
+    });
+    for (const OrderBookEntry* e : incoming)
+    {
+        book.submit(*e, fills);
+    }
+
+    datasetLevels.swap(levels);
+}
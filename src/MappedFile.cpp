@@ -0,0 +1,106 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+: mapped(nullptr),
+  length(0),
+  opened(false)
+{
+
+}
+
+MappedFile::MappedFile(const std::string& filename)
+: MappedFile()
+{
+#ifdef _WIN32
+    std::ifstream file{filename, std::ios::binary};
+    if (!file.is_open()) return;
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    mapped = buffer.data();
+    length = buffer.size();
+    opened = true;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return;
+    }
+    // an empty file cannot be mapped but is still a valid (empty) input
+    if (info.st_size > 0)
+    {
+        void* addr = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd);
+            return;
+        }
+        // the loaders walk the file front to back
+        ::madvise(addr, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+        mapped = static_cast<const char*>(addr);
+        length = static_cast<std::size_t>(info.st_size);
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    opened = true;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+: MappedFile()
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+#ifdef _WIN32
+        buffer = std::move(other.buffer);
+        mapped = buffer.data();
+#else
+        mapped = other.mapped;
+#endif
+        length = other.length;
+        opened = other.opened;
+        other.mapped = nullptr;
+        other.length = 0;
+        other.opened = false;
+    }
+    return *this;
+}
+
+void MappedFile::release()
+{
+#ifndef _WIN32
+    if (mapped != nullptr)
+    {
+        ::munmap(const_cast<char*>(mapped), length);
+    }
+#else
+    buffer.clear();
+#endif
+    mapped = nullptr;
+    length = 0;
+    opened = false;
+}
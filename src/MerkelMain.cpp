@@ -2,17 +2,22 @@
 #include <iostream>
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "OrderBookEntry.h"
 #include "CSVReader.h"
+#include "SymbolTable.h"
 
 MerkelMain::MerkelMain()
 {
-
+    replay.setDatasets(&datasets);
+    if (datasets.empty()) std::cout << "MerkelMain - no datasets found in data/" << std::endl;
+    currentTime = replay.getCurrentTime();
 };
 
 void MerkelMain::init()
 {
-    currentTime = orderBook.getEarliestTime();
+    replay.rewind();
+    currentTime = replay.getCurrentTime();
 
     wallet.insertCurrency("BTC", 10);
     wallet.insertCurrency("ETH", 10);
@@ -78,9 +83,9 @@ void MerkelMain::printMarketStats()
     for (std::string const& p : orderBook.getKnownProducts())
     {
         std::cout << "\n" << "Product: " << p << std::endl;
-        std::vector<OrderBookEntry> entriesAsk = orderBook.getOrders(OrderBookType::ask, 
+        OrderRange entriesAsk = orderBook.getOrders(OrderBookType::ask, 
                                                                 p, currentTime);
-        std::vector<OrderBookEntry> entriesBid = orderBook.getOrders(OrderBookType::bid, 
+        OrderRange entriesBid = orderBook.getOrders(OrderBookType::bid, 
         p, currentTime);
         std::cout << "Bid seen: " << entriesAsk.size() << std::endl;
         std::cout << "Max bid: " << OrderBook::getHighPrice(entriesAsk, p) << std::endl;
@@ -115,7 +120,7 @@ void MerkelMain::enterAsk()
                 OrderBookType::ask 
             );
             // setting user name
-            obe.username = "Simuser";
+            obe.setUsername("Simuser");
 
             if(wallet.canFulfillOrder(obe))
             {
@@ -154,7 +159,7 @@ void MerkelMain::enterBid()
                 OrderBookType::bid 
             );
             // setting user name
-            obe.username = "Simuser";
+            obe.setUsername("Simuser");
 
             if(wallet.canFulfillOrder(obe))
             {
@@ -181,24 +186,21 @@ void MerkelMain::printWallet()
 void MerkelMain::gotoNextTimeframe()
 {
     std::cout << "Going to next time frame. " << std::endl;
-    for (std::string p : orderBook.getKnownProducts())
+    // the replay settles the simuser's sales into the wallet as it steps
+    for (const ReplayEngine::ProductSales& productSales : replay.step())
     {
-        std::cout << "matching " << p << std::endl;
-        std::vector<OrderBookEntry> sales =  orderBook.matchAsksToBids(p, currentTime);
-        std::cout << "Sales: " << sales.size() << std::endl;
-        for (OrderBookEntry& sale : sales)
+        std::cout << "matching " << SymbolTable::products().name(productSales.product) << std::endl;
+        std::cout << "Sales: " << productSales.sales.size() << std::endl;
+        for (const OrderBookEntry& sale : productSales.sales)
         {
             std::cout << "Sale price: " << sale.price << " amount " << sale.amount << std::endl; 
-            if (sale.username == "simuser")
-            {
-                // update the wallet
-                wallet.processSale(sale);
-            }
         }
         
     }
 
-    currentTime = orderBook.getNextTime(currentTime);
+    // wrap around to the start once the dataset is done
+    if (replay.finished()) replay.rewind();
+    currentTime = replay.getCurrentTime();
 }
  
 int MerkelMain::getUserOption()
@@ -255,7 +257,7 @@ void MerkelMain::printCandleChart()
             std::cout << space << "(" << userProductInput << ")" << " - " << orderTypeStr << "\n" << std::endl;
 
             /** Vector to store the matched timestamps requested from user*/
-            std::vector<std::string> timestamps = orderBook.getKnownTimestamps(userProductInput);
+            const std::vector<std::string>& timestamps = orderBook.getKnownTimestamps(userProductInput);
             std::vector<double> yAxisValUp{0.02190250, 0.02190200, 0.02190150, 0.02190100, 0.02190050, 0.02190000};
             std::vector<double> yAxisValLow{0.02170250, 0.02170200, 0.02170150, 0.02170100, 0.02170050, 0.02170000};
 
@@ -264,48 +266,16 @@ void MerkelMain::printCandleChart()
                 std::cout << std::setw(13) << std::fixed << std::setprecision(8) << yAxisValUp[i] << " | " << std::endl;
             }
 
-            // Loop through known products
-            for (const std::string& product : orderBook.getKnownProducts()) {
-                /* mapped vector to store calculated candles*/
-                std::map<std::string, std::vector<Candlestick>> candlesticksByProduct;
-
-                // Filter entries based on user input
-                std::vector<OrderBookEntry> selectedOrders;
-
-                // Reset counters
-                pricesCounter = 0;
-                timestampsCounter = 0;
-
-                // Loop through timestamps
-                for (size_t i = 0; i < timestamps.size(); ++i) {
-
-                    // Get orders for the specified product, order type, and timestamp
-                    std::vector<OrderBookEntry> orders = orderBook.getOrders(orderType, userProductInput, timestamps[i]);
-
-                    // Filter selected orders based on user input
-                    for (const auto& entry : orders) {
-                        if (entry.product == product && entry.orderType == orderType) {
-                            selectedOrders.push_back(entry);
-                        }
-                    }
-
-                    // Calculate candlestick details
-                    candlesticksByProduct = candle.calculateCandlestickDetails(orderBook, timestamps[i], orderType, selectedOrders);
-
-                    for (const auto& entry : candlesticksByProduct) {
-
-                        // Iterate over the vector associated with each key
-                        for (const auto& candlestick : entry.second) {
-                            // pricesCounter determine how many candles on chart
-                            if(pricesCounter < 6) 
-                            {
-                                if(pricesCounter<1)std::cout << std::setw(13) << std::fixed << std::setprecision(8) << candlestick.close << " |    ";
-                                candle.printCandlestick(candlestick);
-                            }
-                            pricesCounter++;
-                        }
-                    }
+            // candles are built in one pass over the product's timestamps
+            for (const Candle& c : buildCandles(userProductInput, orderType)) {
+                // pricesCounter determine how many candles on chart
+                if (pricesCounter < 6) 
+                {
+                    Candlestick candlestick = CandleStick::toCandlestick(c);
+                    if(pricesCounter<1)std::cout << std::setw(13) << std::fixed << std::setprecision(8) << candlestick.close << " |    ";
+                    candle.printCandlestick(candlestick);
                 }
+                pricesCounter++;
             }
             std::cout << std::endl;
             // displays the values after candle's line
@@ -374,44 +344,14 @@ void MerkelMain::getPrices()
             /** Print  the chart's top label */
             std::cout << space << "(" << userProductInput << ")" << " - " << orderTypeStr << "\n" << std::endl;
 
-            /** Vector to store the matched timestamps requested from user*/
-            std::vector<std::string> times = orderBook.getKnownTimestamps(userProductInput);
-
-
-            // Loop through known products
-            for (const std::string& product : orderBook.getKnownProducts()) {
-                /* mapped vector to store calculated candles*/
-                std::map<std::string, std::vector<Candlestick>> candlesticksByProduct;
-
-                // Filter entries based on user input
-                std::vector<OrderBookEntry> selectedOrders;
-
-                // Loop through timestamps
-                for (size_t i = 0; i < times.size(); ++i) {
-
-                    // Get orders for the specified product, order type, and timestamp
-                    std::vector<OrderBookEntry> orders = orderBook.getOrders(orderType, userProductInput, times[i]);
-
-                    // Filter selected orders based on user input
-                    for (const auto& entry : orders) {
-                        if (entry.product == product && entry.orderType == orderType) {
-                            selectedOrders.push_back(entry);
-                        }
-                    }
-
-                    // Calculate candlestick details
-                    candlesticksByProduct = candle.calculateCandlestickDetails(orderBook, times[i], orderType, selectedOrders);
-
-                    // iterate through selected product and print calculated parameters
-                    for (int j = 0; j < candlesticksByProduct[product].size(); ++j) {
-                        std::cout << " ([Open: " << std::setw(9) << std::fixed << std::setprecision(8) << candlesticksByProduct[product][j].open << "]";
-                        std::cout << " [high: " << std::setw(9) << std::fixed << std::setprecision(8) << candlesticksByProduct[product][j].high << "]";
-                        std::cout << " [low: " << std::setw(9) << std::fixed << std::setprecision(8) << candlesticksByProduct[product][j].low << "]";
-                        std::cout << " [close: " << std::setw(9) << std::fixed << std::setprecision(8) << candlesticksByProduct[product][j].close << "]";
-                        std::cout << " [Timestamps: " << candle.filterTimestamp(times[i]) << "])" << "\n";
-                        std::cout << std::endl;
-                    }
-                }
+            // iterate through the product's candles and print calculated parameters
+            for (const Candle& c : buildCandles(userProductInput, orderType)) {
+                std::cout << " ([Open: " << std::setw(9) << std::fixed << std::setprecision(8) << c.open << "]";
+                std::cout << " [high: " << std::setw(9) << std::fixed << std::setprecision(8) << c.high << "]";
+                std::cout << " [low: " << std::setw(9) << std::fixed << std::setprecision(8) << c.low << "]";
+                std::cout << " [close: " << std::setw(9) << std::fixed << std::setprecision(8) << c.close << "]";
+                std::cout << " [Timestamps: " << CandleStick::toCandlestick(c).timestamp << "])" << "\n";
+                std::cout << std::endl;
             }
         }
     }
@@ -421,6 +361,20 @@ void MerkelMain::getPrices()
     } 
 }
 
+std::vector<Candle> MerkelMain::buildCandles(const std::string& product, OrderBookType type)
+{
+    SymbolId productId;
+    if (!SymbolTable::products().find(product, productId)) return {};
+    // 1 tick wide, so every timestamp is a candle of its own
+    CandleAggregator candles{1};
+    for (std::int64_t timestamp : orderBook.getTimeline())
+    {
+        OrderRange orders = orderBook.getOrders(type, productId, timestamp);
+        candles.add(productId, timestamp, OrderBook::getPriceStats(orders, productId));
+    }
+    return candles.getCandles(productId);
+}
+
 void MerkelMain::processUserOption(int userOption)
 {
     if (userOption == 0) // bad input
@@ -463,10 +417,10 @@ void MerkelMain::processUserOption(int userOption)
 
 void MerkelMain::getMarketStats(const std::string& product, double& currentPrice, double& volume, double& change)
 {
-    std::vector<OrderBookEntry> entries = orderBook.getOrders(OrderBookType::ask, product, currentTime);
+    OrderRange entries = orderBook.getOrders(OrderBookType::ask, product, currentTime);
     
     if (!entries.empty()) {
-        currentPrice = entries[0].price;
+        currentPrice = entries.front().price;
         
         // Calculate volume (sum of all amounts)
         volume = 0.0;
@@ -475,13 +429,13 @@ void MerkelMain::getMarketStats(const std::string& product, double& currentPrice
         }
         
         // Calculate price change (simplified - compare with previous timeframe)
-        std::vector<std::string> times = orderBook.getKnownProducts();
+        const std::vector<std::string>& times = orderBook.getKnownProducts();
         if (times.size() > 1) {
             // For simplicity, we'll use a mock previous price calculation
             // In a real implementation, you'd need to track historical prices
-            std::vector<OrderBookEntry> prevEntries = orderBook.getOrders(OrderBookType::ask, product, currentTime);
+            OrderRange prevEntries = orderBook.getOrders(OrderBookType::ask, product, currentTime);
             if (!prevEntries.empty()) {
-                double prevPrice = prevEntries[0].price;
+                double prevPrice = prevEntries.front().price;
                 change = ((currentPrice - prevPrice) / prevPrice) * 100.0;
             } else {
                 change = 0.0;
@@ -521,7 +475,7 @@ bool MerkelMain::executeOrder(const std::string& product, OrderBookType orderTyp
 
 std::vector<double> MerkelMain::getCurrentPrices(const std::string& product, OrderBookType orderType)
 {
-    std::vector<OrderBookEntry> entries = orderBook.getOrders(orderType, product, currentTime);
+    OrderRange entries = orderBook.getOrders(orderType, product, currentTime);
     std::vector<double> prices;
     
     for (const auto& entry : entries) {
@@ -1,10 +1,12 @@
 #include "OrderBook.h"
 #include "CSVReader.h"
-#include <map>
+#include "OrderBookSnapshot.h"
+#include "Timestamp.h"
+#include "LimitOrderBook.h"
 #include <algorithm>
 #include <iostream>
-
-#include <unordered_set>
+#include <iterator>
+#include <limits>
 
 OrderBook::OrderBook()
 {
@@ -13,267 +15,757 @@ OrderBook::OrderBook()
 
 /** construct, reading a csv data file */
 OrderBook::OrderBook(std::string filename)
+: OrderBook(filename, CSVReader::ReadMode::stream)
 {
-    orders = CSVReader::readCSV(filename);
+
 }
 
-/** return vector of all know products in the dataset*/
-std::vector<std::string> OrderBook::getKnownProducts()
+OrderBook::OrderBook(std::string filename, CSVReader::ReadMode mode)
 {
-    std::vector<std::string> products;
-
-    std::map<std::string,bool> prodMap;
+    loadDataset(filename, mode);
+}
 
-    for (OrderBookEntry& e : orders)
+bool OrderBook::loadDataset(const std::string& filename, CSVReader::ReadMode mode)
+{
+    // binary snapshots are recognised by their header, anything else is csv
+    if (OrderBookSnapshot::isSnapshot(filename))
     {
-        prodMap[e.product] = true;
+        // the entries are copied out of the mapping, which is dropped on return
+        OrderBookSnapshot snapshot{filename};
+        if (snapshot.isOpen()) return addDataset(snapshot.toEntries());
+        std::cout << "OrderBook::loadDataset - could not load snapshot " << filename << std::endl;
+        return false;
     }
-    
-    // now flatten the map to a vector of strings
-    for (auto const& e : prodMap)
+    return addDataset(CSVReader::readCSV(filename, mode));
+}
+
+bool OrderBook::addDataset(std::vector<OrderBookEntry> entries)
+{
+    if (entries.empty()) return false;
+    // stable, so orders sharing a key keep their file order
+    std::stable_sort(entries.begin(), entries.end(), OrderBookEntry::compareByKey);
+    Segment segment{entries.front().timestamp, entries.back().timestamp, nullptr};
+    auto pos = std::upper_bound(segments.begin(), segments.end(), segment.first,
+                                [](std::int64_t t, const Segment& s) { return t < s.first; });
+    if ((pos != segments.end() && pos->first <= segment.last) ||
+        (pos != segments.begin() && std::prev(pos)->last >= segment.first))
     {
-        products.push_back(e.first);
+        std::cout << "OrderBook::addDataset - overlaps a dataset that is already loaded" << std::endl;
+        return false;
     }
 
-    return products;
+    std::vector<std::int64_t> times;
+    for (OrderBookEntry& e : entries)
+    {
+        e.id = OrderBookEntry::newId();
+        catalogue.add(e.product, e.timestamp);
+        if (times.empty() || times.back() != e.timestamp) times.push_back(e.timestamp);
+    }
+    segment.orders = std::make_shared<const std::vector<OrderBookEntry>>(std::move(entries));
+    segments.insert(pos, segment);
+    mergeIntoTimeline(times);
+
+    // runs made before this data arrived start with its orders too, which
+    // moves the slots of the orders placed in them
+    std::map<RunKey, std::size_t> shifted;
+    for (auto run = runs.lower_bound(RunKey{segment.first, 0, OrderBookType::bid});
+         run != runs.end() && std::get<0>(run->first) <= segment.last; ++run)
+    {
+        const OrderBookEntry key{0, 0, std::get<0>(run->first), std::get<1>(run->first), std::get<2>(run->first)};
+        OrderRange shared = datasetRun(key);
+        if (shared.empty()) continue;
+        run->second.insert(run->second.begin(), shared.begin(), shared.end());
+        shifted.emplace(run->first, shared.size());
+    }
+    if (shifted.empty()) return true;
+    for (auto& order : placed)
+    {
+        auto shift = shifted.find(runKey(order.second.order));
+        if (shift != shifted.end()) order.second.slot += shift->second;
+    }
+    return true;
 }
 
-/** Return known timestamps from an x product */
-std::vector<std::string> OrderBook::getKnownTimestamps(std::string product)
+void OrderBook::unloadDatasets(std::int64_t from, std::int64_t to)
 {
-    std::vector<std::string> timestamps;
+    auto unloaded = std::remove_if(segments.begin(), segments.end(),
+                                   [&](const Segment& s) { return s.first >= from && s.last <= to; });
+    if (unloaded == segments.end()) return;
+    for (auto s = unloaded; s != segments.end(); ++s)
+    {
+        // orders inserted at those times go with them
+        runs.erase(runs.lower_bound(RunKey{s->first, 0, OrderBookType::bid}),
+                   runs.upper_bound(RunKey{s->last, std::numeric_limits<SymbolId>::max(), OrderBookType::bidsale}));
+    }
+    segments.erase(unloaded, segments.end());
+    rebuildIndex();
+}
 
-    std::map<std::string, bool> timeMap;
+std::vector<std::pair<std::int64_t, std::int64_t>> OrderBook::getDatasetRanges() const
+{
+    std::vector<std::pair<std::int64_t, std::int64_t>> ranges;
+    for (const Segment& s : segments) ranges.emplace_back(s.first, s.last);
+    return ranges;
+}
 
-    for (const OrderBookEntry& e : orders)
+void OrderBook::rebuildIndex()
+{
+    catalogue.clear();
+    timeline.clear();
+    for (const Segment& s : segments)
     {
-        if (e.product == product)
+        for (const OrderBookEntry& e : *s.orders)
         {
-            timeMap[e.timestamp] = true;
+            catalogue.add(e.product, e.timestamp);
+            if (timeline.empty() || timeline.back() != e.timestamp) timeline.push_back(e.timestamp);
         }
     }
-
-    // now flatten the map to a vector of strings
-    for (const auto& e : timeMap)
+    std::vector<std::int64_t> times;
+    for (const auto& run : runs)
     {
-        timestamps.push_back(e.first);
+        OrderRange orders{run.second};
+        for (const OrderBookEntry& e : orders) catalogue.add(e.product, e.timestamp);
+        if (!orders.empty() && (times.empty() || times.back() != std::get<0>(run.first)))
+        {
+            times.push_back(std::get<0>(run.first));
+        }
     }
+    mergeIntoTimeline(times);
+    // products still trading from an earlier day stay known and keep being matched
+    for (const auto& live : liveBooks) catalogue.add(live.first);
+    for (const auto& order : placed) catalogue.add(order.second.order.product);
+}
 
-    return timestamps;
+void OrderBook::mergeIntoTimeline(const std::vector<std::int64_t>& times)
+{
+    if (times.empty()) return;
+    std::vector<std::int64_t> merged;
+    merged.reserve(timeline.size() + times.size());
+    std::set_union(timeline.begin(), timeline.end(), times.begin(), times.end(), std::back_inserter(merged));
+    timeline.swap(merged);
 }
 
-/** return vector of Orders according to the sent filters*/
-std::vector<OrderBookEntry> OrderBook::getOrders(OrderBookType type, 
-                                        std::string product, 
-                                        std::string timestamp)
+void OrderBook::addToTimeline(std::int64_t timestamp)
 {
-    std::vector<OrderBookEntry> orders_sub;
-    for (OrderBookEntry& e : orders)
-    {
-        if (e.orderType == type && 
-            e.product == product && 
-            e.timestamp == timestamp )
-            {
-                orders_sub.push_back(e);
-            }
-    }
-    return orders_sub;
+    auto it = std::lower_bound(timeline.begin(), timeline.end(), timestamp);
+    if (it == timeline.end() || *it != timestamp) timeline.insert(it, timestamp);
 }
 
-double OrderBook::getHighPrice(std::vector<OrderBookEntry>& orders, std::string product)
+std::int64_t OrderBook::toTicks(const std::string& timestamp)
 {
-    double max = orders[0].price;
-    std::string identity = orders[0].product;
-    for (OrderBookEntry& e : orders)
-    {
-        if (e.price > max)
-        {
-            max = e.price;
-            identity = e.product;
-        }
-    }
-    return max;
+    std::int64_t ticks;
+    if (!Timestamp::parse(timestamp, ticks)) ticks = std::numeric_limits<std::int64_t>::min();
+    return ticks;
+}
+
+/** return all known products in the dataset*/
+const std::vector<std::string>& OrderBook::getKnownProducts() const
+{
+    return catalogue.getProducts();
+}
+
+/** Return known timestamps from an x product */
+const std::vector<std::string>& OrderBook::getKnownTimestamps(const std::string& product) const
+{
+    return catalogue.getTimestamps(product);
 }
 
+/** return the Orders matching the sent filters*/
+OrderRange OrderBook::getOrders(OrderBookType type, 
+                                std::string product, 
+                                std::string timestamp)
+{
+    SymbolId productId;
+    std::int64_t ticks;
+    if (!toKeys(product, timestamp, productId, ticks)) return OrderRange{};
+    return getOrders(type, productId, ticks);
+}
 
-double OrderBook::getLowPrice(std::vector<OrderBookEntry>& orders, std::string product)
+OrderRange OrderBook::getOrders(OrderBookType type,
+                                SymbolId product,
+                                std::int64_t timestamp) const
 {
-    double min = orders[0].price;
-    std::string identity = orders[0].product;
-    for (OrderBookEntry& e : orders)
+    const OrderBookEntry key{0, 0, timestamp, product, type};
+    // a key that has seen inserts has its own copy of the run
+    if (!runs.empty())
     {
-        if (e.price < min) {
-            min = e.price;
-            identity = e.product;
-        }
+        auto run = runs.find(runKey(key));
+        if (run != runs.end()) return OrderRange{run->second};
     }
-    return min;
+    return datasetRun(key);
 }
 
-double OrderBook::getAveragePrice(std::vector<OrderBookEntry>& orders, std::string product)
+OrderRange OrderBook::datasetRun(const OrderBookEntry& key) const
 {
-    float sum = 0.0;
-    int count = 0;
-    std::string identity;
+    // the one dataset whose time range can hold the key
+    auto after = std::upper_bound(segments.begin(), segments.end(), key.timestamp,
+                                  [](std::int64_t t, const Segment& s) { return t < s.first; });
+    if (after == segments.begin()) return OrderRange{};
+    const std::vector<OrderBookEntry>& orders = *std::prev(after)->orders;
+    // every entry with this key sits in one run of the sorted dataset
+    auto range = std::equal_range(orders.begin(), orders.end(), key, OrderBookEntry::compareByKey);
+    return OrderRange{orders.data() + (range.first - orders.begin()),
+                      orders.data() + (range.second - orders.begin())};
+}
+
+std::vector<OrderBookEntry>& OrderBook::ownRun(const OrderBookEntry& key)
+{
+    auto run = runs.find(runKey(key));
+    if (run != runs.end()) return run->second;
+    // copy on write: the shared dataset is never modified
+    OrderRange shared = datasetRun(key);
+    return runs.emplace(runKey(key), shared.toVector()).first->second;
+}
+
+std::vector<OrderBookEntry>* OrderBook::findRun(const OrderBookEntry& key)
+{
+    auto run = runs.find(runKey(key));
+    return run == runs.end() ? nullptr : &run->second;
+}
+
+bool OrderBook::toKeys(const std::string& product, const std::string& timestamp,
+                       SymbolId& productId, std::int64_t& ticks)
+{
+    // a product that was never interned cannot have any orders
+    return SymbolTable::products().find(product, productId) && Timestamp::parse(timestamp, ticks);
+}
+
+PriceStats OrderBook::getPriceStats(OrderRange orders, SymbolId product)
+{
+    // entries hold prices and amounts 40 bytes apart, the kernel wants them
+    // as columns. They are copied over a block at a time, so the columns
+    // stay in cache and nothing is allocated
+    constexpr std::size_t block = 256;
+    double prices[block];
+    double amounts[block];
+    PriceStats stats;
+    std::size_t n = 0;
     for (const OrderBookEntry& e : orders)
     {
-        if (e.product == product)
+        if (e.product != product) continue;
+        prices[n] = e.price;
+        amounts[n] = e.amount;
+        if (++n == block)
         {
-            sum += e.price;
-            count++;
-            identity = e.product; // Assuming you want the product of the last matching entry
+            stats.merge(PriceStats::compute(prices, amounts, n));
+            n = 0;
         }
     }
-    // Avoid division by zero
-    if (count == 0) std::cout<<"OrderBook::getAveragePrice - There is no match"<<std::endl;
+    stats.merge(PriceStats::compute(prices, amounts, n));
+    return stats;
+}
 
-    float average = sum / count;
+PriceStats OrderBook::getPriceStats(OrderRange orders, const std::string& product)
+{
+    SymbolId productId;
+    if (!SymbolTable::products().find(product, productId)) return PriceStats{};
+    return getPriceStats(orders, productId);
+}
+
+double OrderBook::getHighPrice(OrderRange orders, std::string product)
+{
+    return getPriceStats(orders, product).high;
+}
+
+double OrderBook::getLowPrice(OrderRange orders, std::string product)
+{
+    return getPriceStats(orders, product).low;
+}
 
-    return average;
+double OrderBook::getAveragePrice(OrderRange orders, std::string product)
+{
+    PriceStats stats = getPriceStats(orders, product);
+    if (stats.count == 0) std::cout<<"OrderBook::getAveragePrice - There is no match"<<std::endl;
+    return stats.mean();
 }
 
 std::string OrderBook::getEarliestTime()
 {
-    return orders[0].timestamp;
+    if (timeline.empty()) return "";
+    return Timestamp::format(timeline.front());
+}
+
+std::string OrderBook::getLatestTime()
+{
+    if (timeline.empty()) return "";
+    return Timestamp::format(timeline.back());
 }
 
 std::string OrderBook::getNextTime(std::string timestamp)
 {
-    std::string next_timestamp = "";
-    for (OrderBookEntry& e : orders)
-    {
-        if (e.timestamp > timestamp) 
-        {
-            next_timestamp = e.timestamp;
-            break;
-        }
-    }
-    if (next_timestamp == "")
+    if (timeline.empty()) return "";
+    auto it = std::upper_bound(timeline.begin(), timeline.end(), toTicks(timestamp));
+    if (it == timeline.end()) it = timeline.begin();
+    return Timestamp::format(*it);
+}
+
+std::string OrderBook::getPreviousTime(std::string timestamp)
+{
+    if (timeline.empty()) return "";
+    auto it = std::lower_bound(timeline.begin(), timeline.end(), toTicks(timestamp));
+    if (it == timeline.begin()) it = timeline.end();
+    return Timestamp::format(*(it - 1));
+}
+
+std::string OrderBook::seekTime(std::string timestamp)
+{
+    if (timeline.empty()) return "";
+    auto it = std::lower_bound(timeline.begin(), timeline.end(), toTicks(timestamp));
+    if (it == timeline.end()) --it;
+    return Timestamp::format(*it);
+}
+
+std::vector<std::string> OrderBook::getTimesInRange(std::string from, std::string to)
+{
+    std::vector<std::string> times;
+    // an unreadable upper bound means "to the end"
+    std::int64_t last;
+    if (!Timestamp::parse(to, last)) last = std::numeric_limits<std::int64_t>::max();
+    auto first = std::lower_bound(timeline.begin(), timeline.end(), toTicks(from));
+    auto end = std::upper_bound(first, timeline.end(), last);
+    for (auto it = first; it != end; ++it)
     {
-        next_timestamp = orders[0].timestamp;
+        times.push_back(Timestamp::format(*it));
     }
-    return next_timestamp;
+    return times;
 }
 
 // Return ROI(Return on investment)
-double OrderBook::getROI(std::vector<OrderBookEntry>& orders)
+double OrderBook::getROI(OrderRange orders)
 {
-    double in = OrderBook::getLowPrice(orders, orders[0].product);
-    double out = OrderBook::getHighPrice(orders, orders[0].product);
+    if (orders.empty()) return 0;
+    PriceStats stats = getPriceStats(orders, orders.front().product);
+    double in = stats.low;
+    double out = stats.high;
     signed int sell = out-in;
     double ROI = ((sell-in)/in)*100;
     return ROI;
 };
 
 
-void OrderBook::insertOrder(OrderBookEntry& order)
+OrderId OrderBook::insertOrder(const OrderBookEntry& order)
 {
-    orders.push_back(order);
-    std::sort(orders.begin(), orders.end(), OrderBookEntry::compareByTimestamp);
+    OrderBookEntry placedOrder = order;
+    // a run shares one key, so arrival order is the order within it
+    std::vector<OrderBookEntry>& run = ownRun(placedOrder);
+    trackPlaced(placedOrder, run.size());
+    run.push_back(placedOrder);
+    addToTimeline(placedOrder.timestamp);
+    catalogue.add(placedOrder.product, placedOrder.timestamp);
+    return placedOrder.id;
 }
 
-std::vector<OrderBookEntry> OrderBook::matchAsksToBids(std::string product, std::string timestamp)
+void OrderBook::trackPlaced(OrderBookEntry& order, std::size_t slot)
 {
-// asks = orderbook.asks
-    std::vector<OrderBookEntry> asks = getOrders(OrderBookType::ask, 
-                                                 product, 
-                                                 timestamp);
-// bids = orderbook.bids
-    std::vector<OrderBookEntry> bids = getOrders(OrderBookType::bid, 
-                                                 product, 
-                                                    timestamp);
-
-    // sales = []
-    std::vector<OrderBookEntry> sales; 
-
-    // sort asks lowest first
-    std::sort(asks.begin(), asks.end(), OrderBookEntry::compareByPriceAsc);
-    // sort bids highest first
-    std::sort(bids.begin(), bids.end(), OrderBookEntry::compareByPriceDesc);
-    // for ask in asks:
-    std::cout << "max ask " << asks[asks.size()-1].price << std::endl;
-    std::cout << "min ask " << asks[0].price << std::endl;
-    std::cout << "max bid " << bids[0].price << std::endl;
-    std::cout << "min bid " << bids[bids.size()-1].price << std::endl;
-    
-    for (OrderBookEntry& ask : asks)
-    {
-        //std::cout << "Ask p: " << ask.price << " a: " << ask.amount << std::endl;
-    //     for bid in bids:
-        for (OrderBookEntry& bid : bids)
+    if (order.id == 0) order.id = OrderBookEntry::newId();
+    if (order.username != OrderBookEntry::datasetUser()) placed.insert_or_assign(order.id, Placed{order, slot});
+}
+
+void OrderBook::trackFills(const std::vector<LimitOrderBook::Fill>& fills)
+{
+    if (placed.empty()) return;
+    for (const LimitOrderBook::Fill& fill : fills)
+    {
+        for (OrderId id : {fill.takerId, fill.makerId})
         {
-            //std::cout << "bid p: " << bid.price << " a: " << bid.amount << std::endl;
+            auto found = placed.find(id);
+            if (found == placed.end()) continue;
+            OrderBookEntry& order = found->second.order;
+            const double before = order.amount;
+            order.amount -= fill.amount;
+            // the live book drops a rounding remainder as filled, so does this
+            if (LimitOrderBook::isDust(order.amount, before)) placed.erase(found);
+        }
+    }
+}
+
+OrderBookEntry* OrderBook::locate(const Placed& order, std::vector<OrderBookEntry>*& run)
+{
+    // placed orders always live in a run of their own key
+    run = findRun(order.order);
+    if (!run || order.slot >= run->size()) return nullptr;
+    OrderBookEntry& slot = (*run)[order.slot];
+    // a run dropped with its dataset may have been made again since
+    if (slot.id != order.order.id || slot.cancelled) return nullptr;
+    return &slot;
+}
 
-    //         if bid.price >= ask.price # we have a match
-            if (bid.price >= ask.price)
+OrderBookEntry* OrderBook::requeue(Placed& order, std::vector<OrderBookEntry>& run)
+{
+    OrderBookEntry moved = run[order.slot];
+    run[order.slot].cancelled = true;
+    order.slot = run.size();
+    run.push_back(moved);
+    return &run.back();
+}
+
+bool OrderBook::cancelOrder(OrderId id)
+{
+    auto found = placed.find(id);
+    if (found == placed.end()) return false;
+    std::vector<OrderBookEntry>* run;
+    if (OrderBookEntry* slot = locate(found->second, run)) slot->cancelled = true;
+    auto live = liveBooks.find(found->second.order.product);
+    if (live != liveBooks.end()) live->second.getBook().cancel(id);
+    placed.erase(found);
+    return true;
+}
+
+bool OrderBook::amendOrder(OrderId id, double amount)
+{
+    if (amount <= 0) return cancelOrder(id);
+    auto found = placed.find(id);
+    if (found == placed.end()) return false;
+    OrderBookEntry& order = found->second.order;
+
+    std::vector<OrderBookEntry>* run;
+    if (OrderBookEntry* slot = locate(found->second, run))
+    {
+        // more size queues behind the orders already waiting
+        if (amount > order.amount) slot = requeue(found->second, *run);
+        slot->amount = amount;
+    }
+    auto live = liveBooks.find(order.product);
+    if (live != liveBooks.end()) live->second.getBook().amend(id, amount);
+    order.amount = amount;
+    return true;
+}
+
+bool OrderBook::amendOrder(OrderId id, double price, double amount)
+{
+    if (amount <= 0) return cancelOrder(id);
+    auto found = placed.find(id);
+    if (found == placed.end()) return false;
+    OrderBookEntry& order = found->second.order;
+
+    // a new price loses priority: back of the queue for its key
+    std::vector<OrderBookEntry>* run;
+    if (OrderBookEntry* slot = locate(found->second, run))
+    {
+        slot = requeue(found->second, *run);
+        slot->price = price;
+        slot->amount = amount;
+    }
+    order.price = price;
+    order.amount = amount;
+
+    auto live = liveBooks.find(order.product);
+    if (live != liveBooks.end() && live->second.getBook().find(id) != nullptr)
+    {
+        std::vector<LimitOrderBook::Fill>& fills = pendingFills[order.product];
+        std::size_t first = fills.size();
+        live->second.getBook().amend(id, price, amount, fills);
+        trackFills(std::vector<LimitOrderBook::Fill>(fills.begin() + first, fills.end()));
+    }
+    return true;
+}
+
+std::vector<OrderBookEntry> OrderBook::getOpenOrders(const std::string& username) const
+{
+    std::vector<OrderBookEntry> open;
+    SymbolId user;
+    if (!SymbolTable::usernames().find(username, user)) return open;
+    for (const auto& order : placed)
+    {
+        if (order.second.order.username == user) open.push_back(order.second.order);
+    }
+    // ids are handed out in increasing order
+    std::sort(open.begin(), open.end(),
+              [](const OrderBookEntry& a, const OrderBookEntry& b) { return a.id < b.id; });
+    return open;
+}
+
+void OrderBook::insertOrders(std::vector<OrderBookEntry> batch)
+{
+    if (batch.empty()) return;
+    std::stable_sort(batch.begin(), batch.end(), OrderBookEntry::compareByKey);
+
+    // each key's orders go to the back of its run, in batch order,
+    // the same placement insertOrder gives one order at a time
+    std::vector<OrderBookEntry>* run = nullptr;
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        OrderBookEntry& e = batch[i];
+        if (i == 0 || OrderBookEntry::compareByKey(batch[i - 1], e)) run = &ownRun(e);
+        trackPlaced(e, run->size());
+        run->push_back(e);
+    }
+
+    std::vector<std::int64_t> times;
+    for (const OrderBookEntry& e : batch)
+    {
+        if (times.empty() || times.back() != e.timestamp) times.push_back(e.timestamp);
+        catalogue.add(e.product, e.timestamp);
+    }
+    mergeIntoTimeline(times);
+}
+
+std::vector<OrderBookEntry> OrderBook::matchAsksToBids(std::string product, std::string timestamp)
+{
+    SymbolId productId;
+    std::int64_t ticks;
+    if (!toKeys(product, timestamp, productId, ticks)) return std::vector<OrderBookEntry>{};
+
+    std::vector<LimitOrderBook::Fill> fills;
+    LiveBook* live = beginShard(productId, fills);
+    std::size_t first = fills.size();
+    matchShard(productId, ticks, live, fills);
+    return settleShard(productId, ticks, fills, first);
+}
+
+std::vector<std::vector<OrderBookEntry>> OrderBook::matchAllProducts(const std::string& timestamp,
+                                                                     ThreadPool& pool)
+{
+    std::int64_t ticks;
+    if (!Timestamp::parse(timestamp, ticks))
+    {
+        return std::vector<std::vector<OrderBookEntry>>(getKnownProducts().size());
+    }
+    return matchAllProducts(ticks, pool);
+}
+
+std::vector<std::vector<OrderBookEntry>> OrderBook::matchAllProducts(std::int64_t ticks, ThreadPool& pool)
+{
+    const std::vector<std::string>& products = getKnownProducts();
+    std::vector<std::vector<OrderBookEntry>> sales(products.size());
+
+    struct Shard
+    {
+        SymbolId product;
+        LiveBook* live;
+        std::vector<LimitOrderBook::Fill> fills;
+        std::size_t first;
+    };
+    // everything shared is touched here, before the workers start, so each
+    // worker only writes to its own shard
+    std::vector<Shard> shards(products.size());
+    for (std::size_t i = 0; i < products.size(); ++i)
+    {
+        Shard& shard = shards[i];
+        shard.product = SymbolTable::products().intern(products[i]);
+        shard.live = beginShard(shard.product, shard.fills);
+        shard.first = shard.fills.size();
+    }
+
+    // dataset orders get ids in whatever order the shards run, which only
+    // shows in Fill ids, never in the sales
+    pool.parallelFor(shards.size(), [this, &shards, ticks](std::size_t i)
+    {
+        Shard& shard = shards[i];
+        matchShard(shard.product, ticks, shard.live, shard.fills);
+    });
+
+    // back on one thread, in product order
+    for (std::size_t i = 0; i < shards.size(); ++i)
+    {
+        sales[i] = settleShard(shards[i].product, ticks, shards[i].fills, shards[i].first);
+    }
+    return sales;
+}
+
+LiveBook* OrderBook::beginShard(SymbolId product, std::vector<LimitOrderBook::Fill>& fills)
+{
+    if (matchMode != MatchMode::persistent) return nullptr;
+    // trades from amendOrder happened first, and are already tracked
+    auto pending = pendingFills.find(product);
+    if (pending != pendingFills.end())
+    {
+        fills.swap(pending->second);
+        pendingFills.erase(pending);
+    }
+    return &liveBooks.try_emplace(product, product).first->second;
+}
+
+void OrderBook::matchShard(SymbolId product, std::int64_t timestamp, LiveBook* live,
+                           std::vector<LimitOrderBook::Fill>& fills) const
+{
+    OrderRange asks = getOrders(OrderBookType::ask, product, timestamp);
+    OrderRange bids = getOrders(OrderBookType::bid, product, timestamp);
+
+    if (live)
+    {
+        live->advance(asks, bids, fills);
+        return;
+    }
+    if (asks.empty() || bids.empty()) return;
+
+    // limit asks never cross each other, so they all rest
+    LimitOrderBook book{product};
+    std::vector<const OrderBookEntry*> immediate;
+    for (const OrderBookEntry& ask : asks)
+    {
+        if (ask.kind == OrderKind::limit) book.submit(ask, fills);
+        else immediate.push_back(&ask);
+    }
+
+    // then limit bids arrive highest first, each taking the cheapest asks,
+    // so every sale happens at the ask price
+    std::vector<const OrderBookEntry*> incoming;
+    incoming.reserve(bids.size());
+    for (const OrderBookEntry& bid : bids)
+    {
+        if (bid.kind == OrderKind::limit) incoming.push_back(&bid);
+        else immediate.push_back(&bid);
+    }
+    std::stable_sort(incoming.begin(), incoming.end(),
+                     [](const OrderBookEntry* a, const OrderBookEntry* b) { return a->price > b->price; });
+    for (const OrderBookEntry* bid : incoming)
+    {
+        book.submit(*bid, fills);
+    }
+
+    // market, ioc and fok orders take from whatever the tick left resting,
+    // in the order they were placed
+    std::sort(immediate.begin(), immediate.end(),
+              [](const OrderBookEntry* a, const OrderBookEntry* b) { return a->id < b->id; });
+    for (const OrderBookEntry* order : immediate)
+    {
+        book.submit(*order, fills);
+    }
+}
+
+std::vector<OrderBookEntry> OrderBook::settleShard(SymbolId product, std::int64_t timestamp,
+                                                   const std::vector<LimitOrderBook::Fill>& fills,
+                                                   std::size_t first)
+{
+    OrderRange asks = getOrders(OrderBookType::ask, product, timestamp);
+    OrderRange bids = getOrders(OrderBookType::bid, product, timestamp);
+
+    if (matchMode == MatchMode::persistent)
+    {
+        trackFills(std::vector<LimitOrderBook::Fill>(fills.begin() + first, fills.end()));
+        // whatever an immediate order did not fill is gone
+        for (OrderRange side : {asks, bids})
+        {
+            for (const OrderBookEntry& e : side)
             {
-    //             sale = new order()
-    //             sale.price = ask.price
-                OrderBookEntry sale{ask.price, 0, timestamp, product, OrderBookType::asksale};
-                if(bid.username == "simuser")
-                {
-                    sale.username = "simuser";
-                    sale.orderType = OrderBookType::bidsale;
-                }
-                if(ask.username == "simuser")
-                {
-                    sale.username = "simuser";
-                    sale.orderType = OrderBookType::asksale;
-                }
-    //             # now work out how much was sold and 
-    //             # create new bids and asks covering 
-    //             # anything that was not sold
-    //             if bid.amount == ask.amount: # bid completely clears ask
-                if (bid.amount == ask.amount)
-                {
-    //                 sale.amount = ask.amount
-                    sale.amount = ask.amount;
-    //                 sales.append(sale)
-                    sales.push_back(sale);
-    //                 bid.amount = 0 # make sure the bid is not processed again
-                    bid.amount = 0;
-    //                 # can do no more with this ask
-    //                 # go onto the next ask
-    //                 break
-                    break;
-                }
-    //           if bid.amount > ask.amount:  # ask is completely gone slice the bid
-                if (bid.amount > ask.amount)
-                {
-    //                 sale.amount = ask.amount
-                    sale.amount = ask.amount;
-    //                 sales.append(sale)
-                    sales.push_back(sale);
-    //                 # we adjust the bid in place
-    //                 # so it can be used to process the next ask
-    //                 bid.amount = bid.amount - ask.amount
-                    bid.amount =  bid.amount - ask.amount;
-    //                 # ask is completely gone, so go to next ask                
-    //                 break
-                    break;
-                }
-
-
-    //             if bid.amount < ask.amount # bid is completely gone, slice the ask
-                if (bid.amount < ask.amount && bid.amount > 0)
-                {
-    //                 sale.amount = bid.amount
-                    sale.amount = bid.amount;
-    //                 sales.append(sale)
-                    sales.push_back(sale);
-    //                 # update the ask
-    //                 # and allow further bids to process the remaining amount
-    //                 ask.amount = ask.amount - bid.amount
-                    ask.amount = ask.amount - bid.amount;
-    //                 bid.amount = 0 # make sure the bid is not processed again
-                    bid.amount = 0;
-    //                 # some ask remains so go to the next bid
-    //                 continue
-                    continue;
-                }
+                if (e.kind != OrderKind::limit) placed.erase(e.id);
             }
         }
     }
-    return sales;             
+    else
+    {
+        // nothing rests past its own tick in this mode
+        for (OrderRange side : {asks, bids})
+        {
+            for (const OrderBookEntry& e : side)
+            {
+                if (e.username != OrderBookEntry::datasetUser()) placed.erase(e.id);
+            }
+        }
+    }
+    return toSales(fills, product, timestamp);
+}
+
+std::vector<OrderBookEntry> OrderBook::toSales(const std::vector<LimitOrderBook::Fill>& fills,
+                                               SymbolId product, std::int64_t timestamp)
+{
+    const SymbolId simuser = SymbolTable::usernames().intern("simuser");
+    std::vector<OrderBookEntry> sales;
+    sales.reserve(fills.size());
+    for (const LimitOrderBook::Fill& fill : fills)
+    {
+        OrderBookEntry sale{fill.price, fill.amount, timestamp, product, OrderBookType::asksale};
+        const bool buyerTook = fill.takerSide == OrderBookType::bid;
+        if (fill.buyer == simuser)
+        {
+            sale.username = simuser;
+            sale.orderType = OrderBookType::bidsale;
+            sale.id = buyerTook ? fill.takerId : fill.makerId;
+        }
+        if (fill.seller == simuser)
+        {
+            sale.username = simuser;
+            sale.orderType = OrderBookType::asksale;
+            sale.id = buyerTook ? fill.makerId : fill.takerId;
+        }
+        sales.push_back(sale);
+    }
+    return sales;
+}
+
+void OrderBook::setMatchMode(MatchMode mode)
+{
+    if (mode == matchMode) return;
+    matchMode = mode;
+    liveBooks.clear();
+    pendingFills.clear();
+}
+
+OrderBook::State OrderBook::getState() const
+{
+    State state;
+    state.matchMode = matchMode;
+    for (const auto& run : runs)
+    {
+        // a run starts with the dataset's orders, which are never removed or moved
+        const OrderBookEntry key{0, 0, std::get<0>(run.first), std::get<1>(run.first), std::get<2>(run.first)};
+        std::size_t shared = datasetRun(key).size();
+        // cancelled slots are left behind, restoring compacts the run
+        OrderRange own{run.second.data() + shared, run.second.data() + run.second.size()};
+        state.inserted.insert(state.inserted.end(), own.begin(), own.end());
+    }
+    state.open.reserve(placed.size());
+    for (const auto& order : placed) state.open.push_back(order.second.order);
+    std::sort(state.open.begin(), state.open.end(),
+              [](const OrderBookEntry& a, const OrderBookEntry& b) { return a.id < b.id; });
+    for (const auto& live : liveBooks)
+    {
+        state.liveBooks.push_back(State::Live{live.first, live.second.getBook().getResting(),
+                                              live.second.getDatasetLevels()});
+    }
+    std::sort(state.liveBooks.begin(), state.liveBooks.end(),
+              [](const State::Live& a, const State::Live& b) { return a.product < b.product; });
+    for (const auto& pending : pendingFills) state.pendingFills.push_back(pending);
+    std::sort(state.pendingFills.begin(), state.pendingFills.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    return state;
 }
 
+void OrderBook::setState(const State& state)
+{
+    // inserts may have added timestamps or products the dataset does not have
+    // and so may the products of live books and open orders
+    bool inserted = !runs.empty() || !liveBooks.empty() || !placed.empty();
+    runs.clear();
+    liveBooks.clear();
+    placed.clear();
+    if (inserted) rebuildIndex();
+    pendingFills.clear();
+    matchMode = state.matchMode;
+
+    OrderId highest = 0;
+    insertOrders(state.inserted);
+    // insertOrders tracks every user order, only the open ones stay tracked,
+    // in the slots it gave them
+    std::unordered_map<OrderId, Placed> tracked;
+    tracked.swap(placed);
+    for (const OrderBookEntry& order : state.inserted) highest = std::max(highest, order.id);
+    for (const OrderBookEntry& order : state.open)
+    {
+        auto found = tracked.find(order.id);
+        // one whose run went with its dataset has no slot
+        const std::size_t slot = found == tracked.end() ? std::numeric_limits<std::size_t>::max()
+                                                        : found->second.slot;
+        placed.insert_or_assign(order.id, Placed{order, slot});
+        catalogue.add(order.product);
+    }
+    for (const State::Live& live : state.liveBooks)
+    {
+        LiveBook& book = liveBooks.try_emplace(live.product, live.product).first->second;
+        book.restore(live.resting, live.levels);
+        catalogue.add(live.product);
+        for (const OrderBookEntry& order : live.resting) highest = std::max(highest, order.id);
+    }
+    for (const auto& pending : state.pendingFills) pendingFills.insert(pending);
+    // orders placed from here on must not reuse a restored id
+    OrderBookEntry::reserveIds(highest);
+}
+
+const LiveBook* OrderBook::getLiveBook(const std::string& product) const
+{
+    SymbolId productId;
+    if (!SymbolTable::products().find(product, productId)) return nullptr;
+    auto found = liveBooks.find(productId);
+    return found == liveBooks.end() ? nullptr : &found->second;
+}
@@ -1,24 +1,91 @@
 #include "OrderBookEntry.h"
+#include "Timestamp.h"
+#include <atomic>
+#include <stdexcept>
+
+namespace
+{
+    std::int64_t parseTimestamp(std::string_view timestamp)
+    {
+        std::int64_t ticks;
+        if (!Timestamp::parse(timestamp, ticks))
+        {
+            throw std::invalid_argument{"OrderBookEntry - bad timestamp " + std::string{timestamp}};
+        }
+        return ticks;
+    }
+}
 
 OrderBookEntry::OrderBookEntry( double _price, 
                         double _amount, 
-                        std::string _timestamp, 
-                        std::string _product, 
+                        std::string_view _timestamp, 
+                        std::string_view _product, 
                         OrderBookType _orderType,
                         // adding user name to data file
-                        std::string _username)
+                        std::string_view _username)
 : price(_price), 
   amount(_amount), 
-  timestamp(_timestamp),
-  product(_product), 
-  orderType(_orderType),
+  timestamp(parseTimestamp(_timestamp)),
+  id(0),
+  product(SymbolTable::products().intern(_product)), 
   // username 
-  username(_username)
+  username(SymbolTable::usernames().intern(_username)),
+  orderType(_orderType),
+  kind(OrderKind::limit),
+  cancelled(false)
 {
     
 }
 
-OrderBookType OrderBookEntry::stringToOrderBookType(std::string s)
+OrderBookEntry::OrderBookEntry( double _price,
+                        double _amount,
+                        std::int64_t _timestamp,
+                        SymbolId _product,
+                        OrderBookType _orderType,
+                        SymbolId _username)
+: price(_price),
+  amount(_amount),
+  timestamp(_timestamp),
+  id(0),
+  product(_product),
+  username(_username),
+  orderType(_orderType),
+  kind(OrderKind::limit),
+  cancelled(false)
+{
+
+}
+
+SymbolId OrderBookEntry::datasetUser()
+{
+    static const SymbolId id = SymbolTable::usernames().intern("dataset");
+    return id;
+}
+
+namespace
+{
+    std::atomic<OrderId> nextId{1};
+}
+
+OrderId OrderBookEntry::newId()
+{
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OrderBookEntry::reserveIds(OrderId id)
+{
+    OrderId next = nextId.load(std::memory_order_relaxed);
+    while (next <= id && !nextId.compare_exchange_weak(next, id + 1, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::string OrderBookEntry::getTimestamp() const
+{
+    return Timestamp::format(timestamp);
+}
+
+OrderBookType OrderBookEntry::stringToOrderBookType(std::string_view s)
 {
   if (s == "ask")
   {
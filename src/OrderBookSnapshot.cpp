@@ -0,0 +1,224 @@
+#include "OrderBookSnapshot.h"
+#include "CSVReader.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+    const char snapshotMagic[8] = {'O', 'B', 'S', 'N', 'A', 'P', '\0', '\0'};
+    // written as-is, reads back differently on a machine of the other endianness
+    const std::uint32_t byteOrderMark = 0x01020304;
+
+    std::uint64_t alignUp(std::uint64_t offset)
+    {
+        return (offset + 7) & ~std::uint64_t{7};
+    }
+
+    void writeAt(std::ofstream& out, std::uint64_t offset, const void* data, std::size_t size)
+    {
+        // pad up to the section start
+        static const char zeros[8] = {};
+        std::uint64_t pos = static_cast<std::uint64_t>(out.tellp());
+        if (offset > pos) out.write(zeros, static_cast<std::streamsize>(offset - pos));
+        if (size > 0) out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+}
+
+OrderBookSnapshot::OrderBookSnapshot()
+: valid(false),
+  rowCount(0),
+  timestampColumn(nullptr),
+  priceColumn(nullptr),
+  amountColumn(nullptr),
+  productColumn(nullptr),
+  sideColumn(nullptr)
+{
+
+}
+
+OrderBookSnapshot::OrderBookSnapshot(const std::string& filename)
+: OrderBookSnapshot()
+{
+    valid = map(filename);
+}
+
+bool OrderBookSnapshot::isSnapshot(const std::string& filename)
+{
+    std::ifstream in{filename, std::ios::binary};
+    char magic[sizeof(snapshotMagic)];
+    if (!in.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, snapshotMagic, sizeof(magic)) == 0;
+}
+
+bool OrderBookSnapshot::map(const std::string& filename)
+{
+    file = MappedFile{filename};
+    if (!file.isOpen() || file.size() < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0) return false;
+    if (header.byteOrder != byteOrderMark)
+    {
+        std::cout << "OrderBookSnapshot::map - snapshot was written with a different byte order" << std::endl;
+        return false;
+    }
+    if (header.version != formatVersion)
+    {
+        std::cout << "OrderBookSnapshot::map - unsupported snapshot version " << header.version << std::endl;
+        return false;
+    }
+
+    const std::uint64_t rows = header.rowCount;
+    const std::uint64_t size = file.size();
+    auto fits = [size](std::uint64_t offset, std::uint64_t bytes)
+    {
+        return offset % 8 == 0 && offset <= size && bytes <= size - offset;
+    };
+    // every row takes this much of the file, which also keeps the column
+    // sizes below from overflowing on a corrupt row count
+    const std::uint64_t rowBytes = sizeof(std::int64_t) + 2 * sizeof(double)
+                                 + sizeof(std::uint16_t) + sizeof(std::uint8_t);
+    if (rows > size / rowBytes ||
+        !fits(header.timestampOffset, rows * sizeof(std::int64_t)) ||
+        !fits(header.priceOffset, rows * sizeof(double)) ||
+        !fits(header.amountOffset, rows * sizeof(double)) ||
+        !fits(header.productOffset, rows * sizeof(std::uint16_t)) ||
+        !fits(header.sideOffset, rows * sizeof(std::uint8_t)) ||
+        !fits(header.productTableOffset, 0))
+    {
+        std::cout << "OrderBookSnapshot::map - truncated snapshot " << filename << std::endl;
+        return false;
+    }
+
+    const char* base = file.data();
+    timestampColumn = reinterpret_cast<const std::int64_t*>(base + header.timestampOffset);
+    priceColumn = reinterpret_cast<const double*>(base + header.priceOffset);
+    amountColumn = reinterpret_cast<const double*>(base + header.amountOffset);
+    productColumn = reinterpret_cast<const std::uint16_t*>(base + header.productOffset);
+    sideColumn = reinterpret_cast<const std::uint8_t*>(base + header.sideOffset);
+
+    std::uint64_t pos = header.productTableOffset;
+    for (std::uint64_t i = 0; i < header.productCount; ++i)
+    {
+        std::uint32_t length;
+        if (size - pos < sizeof(length)) return false;
+        std::memcpy(&length, base + pos, sizeof(length));
+        pos += sizeof(length);
+        if (size - pos < length) return false;
+        productNames.emplace_back(base + pos, length);
+        pos += length;
+    }
+    for (std::uint64_t i = 0; i < rows; ++i)
+    {
+        if (productColumn[i] >= productNames.size()) return false;
+        if (sideColumn[i] > static_cast<std::uint8_t>(OrderBookType::bidsale)) return false;
+    }
+    rowCount = static_cast<std::size_t>(rows);
+    return true;
+}
+
+bool OrderBookSnapshot::write(const std::vector<OrderBookEntry>& entries, const std::string& filename)
+{
+    const std::size_t rows = entries.size();
+    std::vector<std::int64_t> timestamps(rows);
+    std::vector<double> prices(rows);
+    std::vector<double> amounts(rows);
+    std::vector<std::uint16_t> products(rows);
+    std::vector<std::uint8_t> sides(rows);
+    std::vector<std::string> productNames;
+    std::unordered_map<SymbolId, std::uint16_t> productCodes;
+
+    for (std::size_t i = 0; i < rows; ++i)
+    {
+        const OrderBookEntry& e = entries[i];
+        timestamps[i] = e.timestamp;
+        // codes are local to the file, the process-wide ids are not stable
+        auto code = productCodes.find(e.product);
+        if (code == productCodes.end())
+        {
+            code = productCodes.emplace(e.product, static_cast<std::uint16_t>(productNames.size())).first;
+            productNames.push_back(e.getProduct());
+        }
+        products[i] = code->second;
+        prices[i] = e.price;
+        amounts[i] = e.amount;
+        sides[i] = static_cast<std::uint8_t>(e.orderType);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.rowCount = rows;
+    header.productCount = productNames.size();
+    header.timestampOffset = alignUp(sizeof(Header));
+    header.priceOffset = alignUp(header.timestampOffset + rows * sizeof(std::int64_t));
+    header.amountOffset = alignUp(header.priceOffset + rows * sizeof(double));
+    header.productOffset = alignUp(header.amountOffset + rows * sizeof(double));
+    header.sideOffset = alignUp(header.productOffset + rows * sizeof(std::uint16_t));
+    header.productTableOffset = alignUp(header.sideOffset + rows * sizeof(std::uint8_t));
+
+    // write next to the target and rename, so a reader never maps half a file
+    const std::string tempName = filename + ".tmp";
+    {
+        std::ofstream out{tempName, std::ios::binary | std::ios::trunc};
+        if (!out.is_open()) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeAt(out, header.timestampOffset, timestamps.data(), rows * sizeof(std::int64_t));
+        writeAt(out, header.priceOffset, prices.data(), rows * sizeof(double));
+        writeAt(out, header.amountOffset, amounts.data(), rows * sizeof(double));
+        writeAt(out, header.productOffset, products.data(), rows * sizeof(std::uint16_t));
+        writeAt(out, header.sideOffset, sides.data(), rows * sizeof(std::uint8_t));
+        writeAt(out, header.productTableOffset, nullptr, 0);
+        for (const std::string& name : productNames)
+        {
+            std::uint32_t length = static_cast<std::uint32_t>(name.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        if (!out) return false;
+    }
+    // rename replaces an existing snapshot in one step
+    return std::rename(tempName.c_str(), filename.c_str()) == 0;
+}
+
+bool OrderBookSnapshot::convertCSV(const std::string& csvFile, const std::string& snapshotFile)
+{
+    // the reader cannot tell a missing file from an empty one, so look first
+    if (!std::ifstream{csvFile})
+    {
+        std::cout << "OrderBookSnapshot::convertCSV - cannot read " << csvFile << std::endl;
+        return false;
+    }
+    std::vector<OrderBookEntry> entries = CSVReader::readCSV(csvFile, CSVReader::ReadMode::parallel);
+    if (entries.empty())
+    {
+        std::cout << "OrderBookSnapshot::convertCSV - no orders in " << csvFile << std::endl;
+        return false;
+    }
+    return write(entries, snapshotFile);
+}
+
+std::vector<OrderBookEntry> OrderBookSnapshot::toEntries() const
+{
+    std::vector<OrderBookEntry> entries;
+    entries.reserve(rowCount);
+    std::vector<SymbolId> productIds;
+    for (const std::string& name : productNames)
+    {
+        productIds.push_back(SymbolTable::products().intern(name));
+    }
+    for (std::size_t i = 0; i < rowCount; ++i)
+    {
+        entries.emplace_back(priceColumn[i],
+                             amountColumn[i],
+                             timestampColumn[i],
+                             productIds[productColumn[i]],
+                             static_cast<OrderBookType>(sideColumn[i]));
+    }
+    return entries;
+}
@@ -0,0 +1,94 @@
+#include "OrderGateway.h"
+
+OrderGateway::OrderGateway(OrderBook& _book, const std::string& username)
+: book{_book}, owner{SymbolTable::usernames().intern(username)}
+{
+}
+
+OrderId OrderGateway::submit(SymbolId product, OrderBookType side, double price, double amount,
+                             OrderKind kind)
+{
+    // the timestamp is filled in by flush
+    OrderBookEntry order{price, amount, 0, product, side, owner};
+    order.kind = kind;
+    order.id = OrderBookEntry::newId();
+    pending.push_back(Request{Action::submit, order});
+    ++submittedCount;
+    submittedAmount += amount;
+    return order.id;
+}
+
+OrderId OrderGateway::submit(const std::string& product, OrderBookType side, double price, double amount,
+                             OrderKind kind)
+{
+    SymbolId id;
+    if (!SymbolTable::products().find(product, id)) return 0;
+    return submit(id, side, price, amount, kind);
+}
+
+void OrderGateway::cancel(OrderId id)
+{
+    OrderBookEntry order{0, 0, 0, 0, OrderBookType::unknown, owner};
+    order.id = id;
+    pending.push_back(Request{Action::cancel, order});
+}
+
+void OrderGateway::amend(OrderId id, double amount)
+{
+    OrderBookEntry order{0, amount, 0, 0, OrderBookType::unknown, owner};
+    order.id = id;
+    pending.push_back(Request{Action::amend, order});
+}
+
+void OrderGateway::amend(OrderId id, double price, double amount)
+{
+    OrderBookEntry order{price, amount, 0, 0, OrderBookType::unknown, owner};
+    order.id = id;
+    pending.push_back(Request{Action::move, order});
+}
+
+std::vector<OrderBookEntry> OrderGateway::getOpenOrders() const
+{
+    return book.getOpenOrders(SymbolTable::usernames().name(owner));
+}
+
+void OrderGateway::flush(std::int64_t timestamp)
+{
+    // runs of submits go in as one batch
+    std::vector<OrderBookEntry> batch;
+    for (Request& request : pending)
+    {
+        if (request.action == Action::submit)
+        {
+            request.order.timestamp = timestamp;
+            batch.push_back(request.order);
+            continue;
+        }
+        // a cancel or amend may target an order submitted just before it
+        if (!batch.empty())
+        {
+            book.insertOrders(std::move(batch));
+            batch.clear();
+        }
+        switch (request.action)
+        {
+            case Action::cancel:
+                book.cancelOrder(request.order.id);
+                break;
+            case Action::amend:
+                book.amendOrder(request.order.id, request.order.amount);
+                break;
+            case Action::move:
+                book.amendOrder(request.order.id, request.order.price, request.order.amount);
+                break;
+            default:
+                break;
+        }
+    }
+    if (!batch.empty())
+    {
+        book.insertOrders(std::move(batch));
+        batch.clear();
+    }
+    pending.clear();
+}
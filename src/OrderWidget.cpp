@@ -15,6 +15,7 @@
 #include <QTimer>
 #include <QDebug>
 #include <QDate>
+#include <QInputDialog>
 #include <iomanip>
 #include <sstream>
 
@@ -71,12 +72,20 @@ void OrderWidget::setupActiveOrdersTab()
     QPushButton *refreshButton = new QPushButton("Refresh");
     refreshButton->setStyleSheet("QPushButton { background-color: #2196F3; color: white; padding: 8px 16px; }");
     
+    cancelOrderButton = new QPushButton("Cancel");
+    cancelOrderButton->setStyleSheet("QPushButton { background-color: #FF9800; color: white; padding: 8px 16px; }");
+    
+    modifyOrderButton = new QPushButton("Modify");
+    modifyOrderButton->setStyleSheet("QPushButton { background-color: #607D8B; color: white; padding: 8px 16px; }");
+    
     QPushButton *cancelAllButton = new QPushButton("Cancel All");
     cancelAllButton->setStyleSheet("QPushButton { background-color: #f44336; color: white; padding: 8px 16px; }");
     
     controlsLayout->addWidget(filterLabel);
     controlsLayout->addWidget(productFilterCombo);
     controlsLayout->addWidget(refreshButton);
+    controlsLayout->addWidget(cancelOrderButton);
+    controlsLayout->addWidget(modifyOrderButton);
     controlsLayout->addWidget(cancelAllButton);
     controlsLayout->addStretch();
     
@@ -104,7 +113,9 @@ void OrderWidget::setupActiveOrdersTab()
     
     // Connect signals
     connect(refreshButton, &QPushButton::clicked, this, [this]() { updateOrders(""); });
-    connect(cancelAllButton, &QPushButton::clicked, this, &OrderWidget::onCancelOrder);
+    connect(cancelOrderButton, &QPushButton::clicked, this, &OrderWidget::onCancelOrder);
+    connect(modifyOrderButton, &QPushButton::clicked, this, &OrderWidget::onModifyOrder);
+    connect(cancelAllButton, &QPushButton::clicked, this, &OrderWidget::onCancelAllOrders);
     connect(productFilterCombo, QOverload<const QString &>::of(&QComboBox::currentTextChanged),
             this, [this]() { updateOrders(""); });
 }
@@ -221,36 +232,33 @@ void OrderWidget::updateOrders(const std::string& currentTime)
     // Clear existing data
     activeOrdersTable->setRowCount(0);
     
-    // For demonstration, we'll create some mock active orders
-    // In a real application, this would fetch from a database or order management system
     QString productFilter = productFilterCombo->currentText();
     
-    // Add some mock data directly to the table
-    activeOrdersTable->setRowCount(3);
-    
-    activeOrdersTable->setItem(0, 0, new QTableWidgetItem("2024/01/15 10:30:00"));
-    activeOrdersTable->setItem(0, 1, new QTableWidgetItem("BTC/USDT"));
-    activeOrdersTable->setItem(0, 2, new QTableWidgetItem("Limit"));
-    activeOrdersTable->setItem(0, 3, new QTableWidgetItem("Buy"));
-    activeOrdersTable->setItem(0, 4, new QTableWidgetItem("0.001000"));
-    activeOrdersTable->setItem(0, 5, new QTableWidgetItem("45000.00"));
-    activeOrdersTable->setItem(0, 6, new QTableWidgetItem("Open"));
-    
-    activeOrdersTable->setItem(1, 0, new QTableWidgetItem("2024/01/15 11:15:00"));
-    activeOrdersTable->setItem(1, 1, new QTableWidgetItem("ETH/USDT"));
-    activeOrdersTable->setItem(1, 2, new QTableWidgetItem("Limit"));
-    activeOrdersTable->setItem(1, 3, new QTableWidgetItem("Sell"));
-    activeOrdersTable->setItem(1, 4, new QTableWidgetItem("0.500000"));
-    activeOrdersTable->setItem(1, 5, new QTableWidgetItem("3100.00"));
-    activeOrdersTable->setItem(1, 6, new QTableWidgetItem("Open"));
-    
-    activeOrdersTable->setItem(2, 0, new QTableWidgetItem("2024/01/15 12:00:00"));
-    activeOrdersTable->setItem(2, 1, new QTableWidgetItem("DOGE/USDT"));
-    activeOrdersTable->setItem(2, 2, new QTableWidgetItem("Market"));
-    activeOrdersTable->setItem(2, 3, new QTableWidgetItem("Buy"));
-    activeOrdersTable->setItem(2, 4, new QTableWidgetItem("1000.000000"));
-    activeOrdersTable->setItem(2, 5, new QTableWidgetItem("0.25"));
-    activeOrdersTable->setItem(2, 6, new QTableWidgetItem("Pending"));
+    for (const OrderBookEntry& order : orderBook->getOpenOrders(currentUser->getUsername())) {
+        if (productFilter != "All" && QString::fromStdString(order.getProduct()) != productFilter) {
+            continue;
+        }
+        int row = activeOrdersTable->rowCount();
+        activeOrdersTable->insertRow(row);
+        
+        // the order id travels with the row, cancel and modify look it up
+        QTableWidgetItem *timeItem = new QTableWidgetItem(QString::fromStdString(order.getTimestamp()));
+        timeItem->setData(Qt::UserRole, QVariant::fromValue<qulonglong>(order.id));
+        activeOrdersTable->setItem(row, 0, timeItem);
+        activeOrdersTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(order.getProduct())));
+        activeOrdersTable->setItem(row, 2, new QTableWidgetItem("Limit"));
+        activeOrdersTable->setItem(row, 3, new QTableWidgetItem(order.orderType == OrderBookType::bid ? "Buy" : "Sell"));
+        activeOrdersTable->setItem(row, 4, new QTableWidgetItem(QString::number(order.amount, 'f', 6)));
+        activeOrdersTable->setItem(row, 5, new QTableWidgetItem(QString::number(order.price, 'f', 8)));
+        activeOrdersTable->setItem(row, 6, new QTableWidgetItem("Open"));
+    }
+}
+
+OrderId OrderWidget::selectedOrderId() const
+{
+    int row = activeOrdersTable->currentRow();
+    if (row < 0 || !activeOrdersTable->item(row, 0)) return 0;
+    return activeOrdersTable->item(row, 0)->data(Qt::UserRole).toULongLong();
 }
 
 void OrderWidget::updateOrderHistoryTable()
@@ -370,13 +378,35 @@ void OrderWidget::updateTradeStats()
 
 void OrderWidget::onCancelOrder()
 {
+    OrderId id = selectedOrderId();
+    if (!orderBook || id == 0) {
+        QMessageBox::information(this, "Cancel Order", "Select an order to cancel.");
+        return;
+    }
+    
+    if (orderBook->cancelOrder(id)) {
+        emit orderCancelled(QString::number(id));
+    } else {
+        QMessageBox::warning(this, "Cancel Order", "The order has already been filled or cancelled.");
+    }
+    updateOrders(currentTime);
+}
+
+void OrderWidget::onCancelAllOrders()
+{
+    if (!orderBook || !currentUser) return;
+    
     QMessageBox::StandardButton reply = QMessageBox::question(this, "Cancel All Orders", 
         "Are you sure you want to cancel all active orders?",
         QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        // In a real application, this would cancel all orders through the trading API
-        activeOrdersTable->setRowCount(0);
+        for (const OrderBookEntry& order : orderBook->getOpenOrders(currentUser->getUsername())) {
+            if (orderBook->cancelOrder(order.id)) {
+                emit orderCancelled(QString::number(order.id));
+            }
+        }
+        updateOrders(currentTime);
         QMessageBox::information(this, "Orders Cancelled", "All active orders have been cancelled.");
     }
 }
@@ -393,7 +423,31 @@ void OrderWidget::onTabChanged(int index)
 
 void OrderWidget::onModifyOrder()
 {
-    QMessageBox::information(this, "Modify Order", "Order modification functionality would be implemented here.");
+    OrderId id = selectedOrderId();
+    int row = activeOrdersTable->currentRow();
+    if (!orderBook || id == 0) {
+        QMessageBox::information(this, "Modify Order", "Select an order to modify.");
+        return;
+    }
+    
+    double oldAmount = activeOrdersTable->item(row, 4)->text().toDouble();
+    double oldPrice = activeOrdersTable->item(row, 5)->text().toDouble();
+    
+    bool ok = false;
+    double amount = QInputDialog::getDouble(this, "Modify Order", "Amount:", oldAmount, 0.0, 1e12, 6, &ok);
+    if (!ok) return;
+    double price = QInputDialog::getDouble(this, "Modify Order", "Price:", oldPrice, 0.0, 1e12, 8, &ok);
+    if (!ok) return;
+    
+    // a new price loses queue priority, an amount change alone keeps it when shrinking
+    bool amended = price == oldPrice ? orderBook->amendOrder(id, amount)
+                                     : orderBook->amendOrder(id, price, amount);
+    if (amended) {
+        emit orderModified(QString::number(id));
+    } else {
+        QMessageBox::warning(this, "Modify Order", "The order has already been filled or cancelled.");
+    }
+    updateOrders(currentTime);
 }
 
 void OrderWidget::onExportHistory()
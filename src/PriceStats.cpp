@@ -0,0 +1,135 @@
+#include "PriceStats.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+
+#ifdef CPUFEATURES_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    void computeScalar(const double* prices, const double* amounts, std::size_t from,
+                       std::size_t count, PriceStats& stats)
+    {
+        for (std::size_t i = from; i < count; ++i) stats.add(prices[i], amounts[i]);
+    }
+
+    /** fold the lanes of the vector accumulators into stats */
+    void foldLanes(const double* low, const double* high, const double* sum, const double* volume,
+                   const double* notional, std::size_t lanes, std::size_t count, PriceStats& stats)
+    {
+        stats.low = low[0];
+        stats.high = high[0];
+        for (std::size_t l = 0; l < lanes; ++l)
+        {
+            stats.low = std::min(stats.low, low[l]);
+            stats.high = std::max(stats.high, high[l]);
+            stats.sum += sum[l];
+            stats.volume += volume[l];
+            stats.notional += notional[l];
+        }
+        stats.count = count;
+    }
+
+#ifdef CPUFEATURES_X86
+    void computeSSE2(const double* prices, const double* amounts, std::size_t count, PriceStats& stats)
+    {
+        if (count < 2) return computeScalar(prices, amounts, 0, count, stats);
+        __m128d low = _mm_loadu_pd(prices);
+        __m128d high = low;
+        __m128d sum = _mm_setzero_pd();
+        __m128d volume = _mm_setzero_pd();
+        __m128d notional = _mm_setzero_pd();
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128d p = _mm_loadu_pd(prices + i);
+            __m128d a = _mm_loadu_pd(amounts + i);
+            low = _mm_min_pd(low, p);
+            high = _mm_max_pd(high, p);
+            sum = _mm_add_pd(sum, p);
+            volume = _mm_add_pd(volume, a);
+            notional = _mm_add_pd(notional, _mm_mul_pd(p, a));
+        }
+        double l[2], h[2], s[2], v[2], n[2];
+        _mm_storeu_pd(l, low);
+        _mm_storeu_pd(h, high);
+        _mm_storeu_pd(s, sum);
+        _mm_storeu_pd(v, volume);
+        _mm_storeu_pd(n, notional);
+        foldLanes(l, h, s, v, n, 2, i, stats);
+        computeScalar(prices, amounts, i, count, stats);
+    }
+
+    CPUFEATURES_TARGET_AVX2
+    void computeAVX2(const double* prices, const double* amounts, std::size_t count, PriceStats& stats)
+    {
+        if (count < 4) return computeSSE2(prices, amounts, count, stats);
+        __m256d low = _mm256_loadu_pd(prices);
+        __m256d high = low;
+        __m256d sum = _mm256_setzero_pd();
+        __m256d volume = _mm256_setzero_pd();
+        __m256d notional = _mm256_setzero_pd();
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256d p = _mm256_loadu_pd(prices + i);
+            __m256d a = _mm256_loadu_pd(amounts + i);
+            low = _mm256_min_pd(low, p);
+            high = _mm256_max_pd(high, p);
+            sum = _mm256_add_pd(sum, p);
+            volume = _mm256_add_pd(volume, a);
+            notional = _mm256_add_pd(notional, _mm256_mul_pd(p, a));
+        }
+        double l[4], h[4], s[4], v[4], n[4];
+        _mm256_storeu_pd(l, low);
+        _mm256_storeu_pd(h, high);
+        _mm256_storeu_pd(s, sum);
+        _mm256_storeu_pd(v, volume);
+        _mm256_storeu_pd(n, notional);
+        foldLanes(l, h, s, v, n, 4, i, stats);
+        computeScalar(prices, amounts, i, count, stats);
+    }
+#endif
+}
+
+void PriceStats::add(double price, double amount)
+{
+    if (count == 0 || price < low) low = price;
+    if (count == 0 || price > high) high = price;
+    sum += price;
+    ++count;
+    volume += amount;
+    notional += price * amount;
+}
+
+void PriceStats::merge(const PriceStats& other)
+{
+    if (other.count == 0) return;
+    low = count == 0 ? other.low : std::min(low, other.low);
+    high = count == 0 ? other.high : std::max(high, other.high);
+    sum += other.sum;
+    count += other.count;
+    volume += other.volume;
+    notional += other.notional;
+}
+
+PriceStats PriceStats::compute(const double* prices, const double* amounts, std::size_t count)
+{
+    PriceStats stats;
+    switch (CpuFeatures::activeIsa())
+    {
+#ifdef CPUFEATURES_X86
+        case CpuFeatures::Isa::avx2:
+            computeAVX2(prices, amounts, count, stats);
+            break;
+        case CpuFeatures::Isa::sse2:
+            computeSSE2(prices, amounts, count, stats);
+            break;
+#endif
+        default:
+            computeScalar(prices, amounts, 0, count, stats);
+            break;
+    }
+    return stats;
+}
@@ -0,0 +1,58 @@
+#include "ProductCatalogue.h"
+#include "Timestamp.h"
+#include <algorithm>
+
+namespace
+{
+    const std::vector<std::string> noTimestamps;
+}
+
+ProductCatalogue::ProductCatalogue()
+: productChanges{0}, timestampChanges{0}
+{
+
+}
+
+void ProductCatalogue::clear()
+{
+    products.clear();
+    times.clear();
+    ++productChanges;
+    ++timestampChanges;
+}
+
+void ProductCatalogue::add(SymbolId product)
+{
+    if (times.count(product)) return;
+    const std::string& name = SymbolTable::products().name(product);
+    products.insert(std::lower_bound(products.begin(), products.end(), name), name);
+    times.emplace(product, Times{});
+    ++productChanges;
+}
+
+void ProductCatalogue::add(SymbolId product, std::int64_t timestamp)
+{
+    add(product);
+    // orders mostly arrive in time order, so this is usually an append
+    Times& t = times.find(product)->second;
+    auto it = std::lower_bound(t.ticks.begin(), t.ticks.end(), timestamp);
+    if (it != t.ticks.end() && *it == timestamp) return;
+    std::size_t pos = static_cast<std::size_t>(it - t.ticks.begin());
+    t.ticks.insert(it, timestamp);
+    t.formatted.insert(t.formatted.begin() + pos, Timestamp::format(timestamp));
+    ++timestampChanges;
+}
+
+const std::vector<std::string>& ProductCatalogue::getTimestamps(SymbolId product) const
+{
+    auto found = times.find(product);
+    if (found == times.end()) return noTimestamps;
+    return found->second.formatted;
+}
+
+const std::vector<std::string>& ProductCatalogue::getTimestamps(std::string_view product) const
+{
+    SymbolId id;
+    if (!SymbolTable::products().find(product, id)) return noTimestamps;
+    return getTimestamps(id);
+}
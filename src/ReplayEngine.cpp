@@ -0,0 +1,147 @@
+#include "ReplayEngine.h"
+#include "CheckpointLog.h"
+#include "DatasetCatalogue.h"
+#include "MarketView.h"
+#include "Strategy.h"
+#include "SymbolTable.h"
+#include "Timestamp.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+ReplayEngine::ReplayEngine(OrderBook& _book, Wallet& _wallet, unsigned workers)
+: book{_book}, wallet{_wallet}, pool{workers}, strategy{nullptr},
+  gateway{_book, "simuser"}, checkpoints{nullptr}, datasets{nullptr}, checkpointEvery{0}, sinceCheckpoint{0},
+  current{0}, done{true}
+{
+    rewind();
+}
+
+void ReplayEngine::setStrategy(Strategy* _strategy)
+{
+    strategy = _strategy;
+    gateway.discard();
+}
+
+void ReplayEngine::setCheckpoints(CheckpointLog* log, std::size_t every)
+{
+    checkpoints = every > 0 ? log : nullptr;
+    checkpointEvery = every;
+    sinceCheckpoint = 0;
+}
+
+void ReplayEngine::setDatasets(DatasetCatalogue* _datasets)
+{
+    datasets = _datasets;
+    rewind();
+}
+
+void ReplayEngine::rewind()
+{
+    if (datasets && !datasets->empty()) datasets->seek(book, datasets->getDays().front().first);
+    const std::vector<std::int64_t>& timeline = book.getTimeline();
+    done = timeline.empty();
+    current = done ? 0 : timeline.front();
+}
+
+void ReplayEngine::seek(std::int64_t timestamp)
+{
+    if (datasets) datasets->seek(book, timestamp);
+    const std::vector<std::int64_t>& timeline = book.getTimeline();
+    auto at = std::lower_bound(timeline.begin(), timeline.end(), timestamp);
+    done = at == timeline.end();
+    current = done ? 0 : *at;
+    gateway.discard();
+}
+
+std::string ReplayEngine::getCurrentTime() const
+{
+    return done ? std::string{} : Timestamp::format(current);
+}
+
+const std::vector<ReplayEngine::ProductSales>& ReplayEngine::step()
+{
+    if (done)
+    {
+        sales.clear();
+        return sales;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    if (strategy)
+    {
+        MarketView market{book, current};
+        strategy->onTick(market, wallet, gateway);
+        gateway.flush(current);
+    }
+
+    // label the sales now: loading the next day below can change the products
+    const std::vector<std::string>& products = book.getKnownProducts();
+    sales.resize(products.size());
+    for (std::size_t i = 0; i < products.size(); ++i)
+    {
+        SymbolId productId = SymbolTable::products().intern(products[i]);
+        sales[i].product = productId;
+        stats.orders += book.getOrders(OrderBookType::ask, productId, current).size()
+                      + book.getOrders(OrderBookType::bid, productId, current).size();
+    }
+
+    // in the same product order as the labels
+    std::vector<std::vector<OrderBookEntry>> matched = book.matchAllProducts(current, pool);
+    for (std::size_t i = 0; i < sales.size(); ++i) sales[i].sales = std::move(matched[i]);
+
+    // settle one product after another, so the wallet sees the same order every run
+    const SymbolId simuser = SymbolTable::usernames().intern("simuser");
+    for (ProductSales& productSales : sales)
+    {
+        stats.fills += productSales.sales.size();
+        for (OrderBookEntry& sale : productSales.sales)
+        {
+            if (sale.username != simuser) continue;
+            wallet.processSale(sale);
+            if (strategy) strategy->onFill(sale, gateway);
+        }
+    }
+
+    // the timeline may have grown since the last step, so search it again
+    const std::vector<std::int64_t>& timeline = book.getTimeline();
+    auto next = std::upper_bound(timeline.begin(), timeline.end(), current);
+    // out of loaded data, the next day may have more
+    if (next == timeline.end() && datasets && datasets->loadNext(book, current))
+    {
+        next = std::upper_bound(timeline.begin(), timeline.end(), current);
+    }
+    done = next == timeline.end();
+    if (!done) current = *next;
+    // orders placed from onFill go in at the next time
+    if (done) gateway.discard();
+    else gateway.flush(current);
+
+    ++stats.ticks;
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (checkpoints && ++sinceCheckpoint >= checkpointEvery)
+    {
+        checkpoints->append(*this);
+        sinceCheckpoint = 0;
+    }
+    return sales;
+}
+
+void ReplayEngine::run(double speed)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point wallStart = Clock::now();
+    const std::int64_t marketStart = current;
+    while (!done)
+    {
+        if (speed > 0)
+        {
+            // hold each tick back until its market time, scaled by speed, is due
+            double due = (current - marketStart) / (Timestamp::ticksPerSecond * speed);
+            std::this_thread::sleep_until(wallStart + std::chrono::duration_cast<Clock::duration>(
+                                                          std::chrono::duration<double>(due)));
+        }
+        step();
+    }
+}
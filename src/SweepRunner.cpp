@@ -0,0 +1,141 @@
+#include "SweepRunner.h"
+#include "CSVReader.h"
+#include "ReplayEngine.h"
+#include "SymbolTable.h"
+#include <algorithm>
+#include <iomanip>
+
+SweepRunner::SweepRunner(const OrderBook& _book, const Wallet& _wallet, std::string quoteCurrency,
+                         unsigned workers)
+: book{_book}, wallet{_wallet}, quote{std::move(quoteCurrency)}, pool{workers}
+{
+    const std::vector<std::string>& products = book.getKnownProducts();
+    for (std::size_t i = 0; i < products.size(); ++i)
+    {
+        std::vector<std::string> currs = CSVReader::tokenise(products[i], '/');
+        if (currs.size() != 2) continue;
+        // a direct pair to the quote wins over an inverted one
+        if (currs[1] == quote) pairs[currs[0]] = {i, false};
+        else if (currs[0] == quote) pairs.emplace(currs[1], std::make_pair(i, true));
+    }
+    buildMarks();
+}
+
+void SweepRunner::buildMarks()
+{
+    const std::vector<std::int64_t>& timeline = book.getTimeline();
+    const std::vector<std::string>& products = book.getKnownProducts();
+    std::vector<SymbolId> ids;
+    for (const std::string& p : products) ids.push_back(SymbolTable::products().intern(p));
+
+    marks.assign(timeline.size(), std::vector<double>(products.size(), 0));
+    for (std::size_t t = 0; t < timeline.size(); ++t)
+    {
+        for (std::size_t p = 0; p < ids.size(); ++p)
+        {
+            double bestBid = 0;
+            double bestAsk = 0;
+            for (const OrderBookEntry& e : book.getOrders(OrderBookType::bid, ids[p], timeline[t]))
+            {
+                bestBid = std::max(bestBid, e.price);
+            }
+            for (const OrderBookEntry& e : book.getOrders(OrderBookType::ask, ids[p], timeline[t]))
+            {
+                if (bestAsk == 0 || e.price < bestAsk) bestAsk = e.price;
+            }
+            double mid = bestBid > 0 && bestAsk > 0 ? (bestBid + bestAsk) / 2 : std::max(bestBid, bestAsk);
+            if (mid == 0 && t > 0) mid = marks[t - 1][p];
+            marks[t][p] = mid;
+        }
+    }
+}
+
+std::size_t SweepRunner::markIndex(std::int64_t timestamp) const
+{
+    const std::vector<std::int64_t>& timeline = book.getTimeline();
+    auto after = std::upper_bound(timeline.begin(), timeline.end(), timestamp);
+    return after == timeline.begin() ? 0 : static_cast<std::size_t>(after - timeline.begin()) - 1;
+}
+
+double SweepRunner::value(const Wallet& w, std::size_t tick) const
+{
+    double total = 0;
+    for (const auto& held : w.getCurrencies())
+    {
+        if (held.first == quote)
+        {
+            total += held.second;
+            continue;
+        }
+        auto pair = pairs.find(held.first);
+        if (pair == pairs.end() || marks.empty()) continue;
+        double mark = marks[tick][pair->second.first];
+        if (mark <= 0) continue;
+        total += pair->second.second ? held.second / mark : held.second * mark;
+    }
+    return total;
+}
+
+std::vector<SweepRunner::Result> SweepRunner::run(std::size_t runs, const StrategyFactory& factory)
+{
+    std::vector<Result> results(runs);
+    // runs differ in length, so workers take the next run as they free up
+    pool.parallelFor(runs, [this, &results, &factory](std::size_t i)
+    {
+        results[i] = runOne(i, factory);
+    });
+    return results;
+}
+
+SweepRunner::Result SweepRunner::runOne(std::size_t run, const StrategyFactory& factory) const
+{
+    Result result;
+    result.run = run;
+
+    // copies of the book share the dataset, see OrderBook
+    OrderBook runBook{book};
+    Wallet runWallet{wallet};
+    // runs are the unit of parallelism, each one matches on its own thread
+    ReplayEngine replay{runBook, runWallet, 1};
+    std::unique_ptr<Strategy> strategy = factory(run);
+    replay.setStrategy(strategy.get());
+
+    const SymbolId simuser = SymbolTable::usernames().intern("simuser");
+    const double start = value(runWallet, 0);
+    double equity = start;
+    double peak = start;
+    double filled = 0;
+    while (!replay.finished())
+    {
+        std::size_t tick = markIndex(replay.getCurrentTick());
+        for (const ReplayEngine::ProductSales& productSales : replay.step())
+        {
+            for (const OrderBookEntry& sale : productSales.sales)
+            {
+                if (sale.username != simuser) continue;
+                ++result.trades;
+                filled += sale.amount;
+            }
+        }
+        equity = value(runWallet, tick);
+        peak = std::max(peak, equity);
+        result.maxDrawdown = std::max(result.maxDrawdown, peak - equity);
+    }
+    replay.setStrategy(nullptr);
+
+    result.pnl = equity - start;
+    double submitted = replay.getGateway().getSubmittedAmount();
+    result.fillRatio = submitted > 0 ? filled / submitted : 0;
+    return result;
+}
+
+void SweepRunner::printResults(const std::vector<Result>& results, std::ostream& out)
+{
+    out << std::setw(6) << "run" << std::setw(16) << "pnl" << std::setw(10) << "trades"
+        << std::setw(12) << "fill ratio" << std::setw(16) << "max drawdown" << std::endl;
+    for (const Result& r : results)
+    {
+        out << std::setw(6) << r.run << std::setw(16) << r.pnl << std::setw(10) << r.trades
+            << std::setw(12) << r.fillRatio << std::setw(16) << r.maxDrawdown << std::endl;
+    }
+}
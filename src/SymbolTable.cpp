@@ -0,0 +1,58 @@
+#include "SymbolTable.h"
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+SymbolTable& SymbolTable::products()
+{
+    static SymbolTable table;
+    return table;
+}
+
+SymbolTable& SymbolTable::usernames()
+{
+    static SymbolTable table;
+    return table;
+}
+
+SymbolId SymbolTable::intern(std::string_view name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock{mutex};
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    // another thread may have added it between the two locks
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+    if (names.size() > std::numeric_limits<SymbolId>::max())
+    {
+        throw std::length_error{"SymbolTable::intern - table is full"};
+    }
+    SymbolId id = static_cast<SymbolId>(names.size());
+    names.emplace_back(name);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+bool SymbolTable::find(std::string_view name, SymbolId& id) const
+{
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    auto it = ids.find(name);
+    if (it == ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+const std::string& SymbolTable::name(SymbolId id) const
+{
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    return names.at(id);
+}
+
+std::size_t SymbolTable::size() const
+{
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    return names.size();
+}
@@ -0,0 +1,105 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+struct ThreadPool::Batch
+{
+    const std::function<void(std::size_t)>* task;
+    std::size_t count;
+    /** next task index nobody has claimed yet */
+    std::atomic<std::size_t> next{0};
+    /** workers inside drain, guarded by the pool mutex */
+    unsigned users = 0;
+    std::condition_variable finished;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(unsigned workers)
+{
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    // the thread calling parallelFor is one of the workers
+    threads.reserve(workers - 1);
+    for (unsigned i = 1; i < workers; ++i)
+    {
+        threads.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task)
+{
+    if (count == 0) return;
+    if (threads.empty() || count == 1)
+    {
+        for (std::size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+
+    Batch batch;
+    batch.task = &task;
+    batch.count = count;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        batches.push_back(&batch);
+    }
+    wake.notify_all();
+
+    drain(batch);
+
+    std::unique_lock<std::mutex> lock{mutex};
+    // every task is claimed, so no worker may pick the batch up again
+    auto queued = std::find(batches.begin(), batches.end(), &batch);
+    if (queued != batches.end()) batches.erase(queued);
+    batch.finished.wait(lock, [&batch]() { return batch.users == 0; });
+    lock.unlock();
+
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    for (;;)
+    {
+        wake.wait(lock, [this]() { return stopping || !batches.empty(); });
+        if (batches.empty()) return;
+
+        Batch* batch = batches.front();
+        ++batch->users;
+        lock.unlock();
+        drain(*batch);
+        lock.lock();
+
+        if (!batches.empty() && batches.front() == batch) batches.pop_front();
+        if (--batch->users == 0) batch->finished.notify_all();
+    }
+}
+
+void ThreadPool::drain(Batch& batch)
+{
+    for (;;)
+    {
+        std::size_t i = batch.next.fetch_add(1);
+        if (i >= batch.count) return;
+        try
+        {
+            (*batch.task)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock{batch.errorMutex};
+            if (!batch.error) batch.error = std::current_exception();
+        }
+    }
+}
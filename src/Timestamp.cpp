@@ -0,0 +1,135 @@
+#include "Timestamp.h"
+
+namespace
+{
+    /** read exactly n digits at text[pos], advancing pos */
+    bool readDigits(std::string_view text, std::size_t& pos, int n, int& value)
+    {
+        if (pos + n > text.size()) return false;
+        value = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            char c = text[pos + i];
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + (c - '0');
+        }
+        pos += n;
+        return true;
+    }
+
+    bool expect(std::string_view text, std::size_t& pos, char c)
+    {
+        if (pos >= text.size() || text[pos] != c) return false;
+        ++pos;
+        return true;
+    }
+
+    // days between 1970/01/01 and y/m/d in the proleptic Gregorian calendar
+    std::int64_t daysFromCivil(int y, int m, int d)
+    {
+        y -= m <= 2;
+        const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const int yoe = static_cast<int>(y - era * 400);
+        const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    void civilFromDays(std::int64_t z, int& y, int& m, int& d)
+    {
+        z += 719468;
+        const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const int doe = static_cast<int>(z - era * 146097);
+        const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int mp = (5 * doy + 2) / 153;
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp + (mp < 10 ? 3 : -9);
+        y = static_cast<int>(yoe + era * 400) + (m <= 2);
+    }
+
+    void putDigits(char* out, int value, int n)
+    {
+        for (int i = n - 1; i >= 0; --i)
+        {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+}
+
+bool Timestamp::parse(std::string_view text, std::int64_t& ticks)
+{
+    std::size_t pos = 0;
+    int year, month, day, hour, minute, second;
+    if (!readDigits(text, pos, 4, year) || !expect(text, pos, '/') ||
+        !readDigits(text, pos, 2, month) || !expect(text, pos, '/') ||
+        !readDigits(text, pos, 2, day) || !expect(text, pos, ' ') ||
+        !readDigits(text, pos, 2, hour) || !expect(text, pos, ':') ||
+        !readDigits(text, pos, 2, minute) || !expect(text, pos, ':') ||
+        !readDigits(text, pos, 2, second))
+    {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    {
+        return false;
+    }
+
+    std::int64_t micros = 0;
+    if (pos < text.size())
+    {
+        if (!expect(text, pos, '.')) return false;
+        int digits = 0;
+        while (pos < text.size() && digits < 6)
+        {
+            char c = text[pos];
+            if (c < '0' || c > '9') return false;
+            micros = micros * 10 + (c - '0');
+            ++pos;
+            ++digits;
+        }
+        if (pos != text.size()) return false;
+        for (; digits < 6; ++digits) micros *= 10;
+    }
+
+    std::int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    ticks = seconds * ticksPerSecond + micros;
+    return true;
+}
+
+std::string Timestamp::format(std::int64_t ticks)
+{
+    std::int64_t seconds = ticks / ticksPerSecond;
+    std::int64_t micros = ticks % ticksPerSecond;
+    if (micros < 0)
+    {
+        micros += ticksPerSecond;
+        --seconds;
+    }
+    std::int64_t days = seconds / 86400;
+    std::int64_t secondOfDay = seconds % 86400;
+    if (secondOfDay < 0)
+    {
+        secondOfDay += 86400;
+        --days;
+    }
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+
+    // YYYY/MM/DD HH:MM:SS.ffffff
+    std::string out(26, ' ');
+    putDigits(&out[0], year, 4);
+    out[4] = '/';
+    putDigits(&out[5], month, 2);
+    out[7] = '/';
+    putDigits(&out[8], day, 2);
+    putDigits(&out[11], static_cast<int>(secondOfDay / 3600), 2);
+    out[13] = ':';
+    putDigits(&out[14], static_cast<int>(secondOfDay / 60 % 60), 2);
+    out[16] = ':';
+    putDigits(&out[17], static_cast<int>(secondOfDay % 60), 2);
+    out[19] = '.';
+    putDigits(&out[20], static_cast<int>(micros), 6);
+    return out;
+}
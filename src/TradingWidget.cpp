@@ -13,6 +13,7 @@
 #include <QHeaderView>
 #include <QTimer>
 #include <QDebug>
+#include <QSignalBlocker>
 #include <iomanip>
 #include <sstream>
 
@@ -21,6 +22,7 @@ TradingWidget::TradingWidget(QWidget *parent)
     , orderBook(nullptr)
     , currentUser(nullptr)
     , selectedProduct("BTC/USDT")
+    , productsVersion(0)
     , currentPrice(0.0)
     , bidPrice(0.0)
     , askPrice(0.0)
@@ -130,6 +132,14 @@ void TradingWidget::setupOrderForm()
     priceSpinBox->setDecimals(8);
     priceSpinBox->setEnabled(false); // Disabled for market orders initially
     
+    // Time in force (for limit orders)
+    QLabel *timeInForceLabel = new QLabel("Time in Force:");
+    timeInForceCombo = new QComboBox();
+    timeInForceCombo->addItem("Good Till Cancelled", static_cast<int>(OrderKind::limit));
+    timeInForceCombo->addItem("Immediate or Cancel", static_cast<int>(OrderKind::ioc));
+    timeInForceCombo->addItem("Fill or Kill", static_cast<int>(OrderKind::fok));
+    timeInForceCombo->setEnabled(false);
+    
     // Total
     totalLabel = new QLabel("Total: $0.00");
     totalLabel->setStyleSheet("font-weight: bold;");
@@ -144,6 +154,7 @@ void TradingWidget::setupOrderForm()
     orderFormLayout->addRow("", limitOrderRadio);
     orderFormLayout->addRow(amountLabel, amountSpinBox);
     orderFormLayout->addRow(priceLabel, priceSpinBox);
+    orderFormLayout->addRow(timeInForceLabel, timeInForceCombo);
     orderFormLayout->addRow(totalLabel);
     
     QHBoxLayout *buttonLayout = new QHBoxLayout();
@@ -213,6 +224,7 @@ void TradingWidget::connectSignals()
             this, &TradingWidget::onProductChanged);
     connect(marketOrderRadio, &QRadioButton::toggled, this, &TradingWidget::calculateOrderTotal);
     connect(limitOrderRadio, &QRadioButton::toggled, this, &TradingWidget::calculateOrderTotal);
+    connect(limitOrderRadio, &QRadioButton::toggled, this, &TradingWidget::onOrderTypeChanged);
     connect(amountSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &TradingWidget::calculateOrderTotal);
     connect(priceSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &TradingWidget::calculateOrderTotal);
     connect(buyButton, &QPushButton::clicked, this, &TradingWidget::onBuyOrder);
@@ -230,6 +242,7 @@ void TradingWidget::connectSignals()
 void TradingWidget::setOrderBook(OrderBook *book)
 {
     orderBook = book;
+    refreshProducts();
     updateOrderBook();
 }
 
@@ -240,11 +253,30 @@ void TradingWidget::setUser(std::shared_ptr<User> user)
 
 
 
+void TradingWidget::refreshProducts()
+{
+    if (!orderBook || orderBook->getCatalogue().productsVersion() == productsVersion) return;
+    productsVersion = orderBook->getCatalogue().productsVersion();
+
+    // refill without firing onProductChanged for the intermediate states
+    QSignalBlocker blocker(productCombo);
+    productCombo->clear();
+    for (const std::string& product : orderBook->getKnownProducts()) {
+        productCombo->addItem(QString::fromStdString(product));
+    }
+    productCombo->setCurrentText(QString::fromStdString(selectedProduct));
+    // the old selection may not exist in this dataset
+    if (productCombo->count() > 0) {
+        selectedProduct = productCombo->currentText().toStdString();
+    }
+}
+
 void TradingWidget::updateMarketData(const std::string& currentTime)
 {
     if (!orderBook) return;
     
     this->currentTime = currentTime;
+    refreshProducts();
     
     // Update price display based on order book data
     updatePriceDisplay();
@@ -276,18 +308,19 @@ void TradingWidget::updateOrderBook()
     if (currentTime.empty()) return;
     
     // Get ask orders (sells)
-    std::vector<OrderBookEntry> asks = orderBook->getOrders(OrderBookType::ask, selectedProduct, currentTime);
+    OrderRange asks = orderBook->getOrders(OrderBookType::ask, selectedProduct, currentTime);
     
     // Get bid orders (buys)
-    std::vector<OrderBookEntry> bids = orderBook->getOrders(OrderBookType::bid, selectedProduct, currentTime);
+    OrderRange bids = orderBook->getOrders(OrderBookType::bid, selectedProduct, currentTime);
     
     // Display top 10 asks and bids
     int maxRows = std::max(std::min(10, static_cast<int>(asks.size())), std::min(10, static_cast<int>(bids.size())));
     orderBookTable->setRowCount(maxRows * 2);
     
     // Add asks (red background)
-    for (int i = 0; i < std::min(10, static_cast<int>(asks.size())); ++i) {
-        const auto& ask = asks[i];
+    auto nextAsk = asks.begin();
+    for (int i = 0; i < std::min(10, static_cast<int>(asks.size())); ++i, ++nextAsk) {
+        const auto& ask = *nextAsk;
         
         QTableWidgetItem *priceItem = new QTableWidgetItem(QString::number(ask.price, 'f', 2));
         QTableWidgetItem *amountItem = new QTableWidgetItem(QString::number(ask.amount, 'f', 4));
@@ -303,8 +336,9 @@ void TradingWidget::updateOrderBook()
     }
     
     // Add bids (green background)
-    for (int i = 0; i < std::min(10, static_cast<int>(bids.size())); ++i) {
-        const auto& bid = bids[i];
+    auto nextBid = bids.begin();
+    for (int i = 0; i < std::min(10, static_cast<int>(bids.size())); ++i, ++nextBid) {
+        const auto& bid = *nextBid;
         int row = maxRows + i;
         
         QTableWidgetItem *priceItem = new QTableWidgetItem(QString::number(bid.price, 'f', 2));
@@ -337,6 +371,7 @@ void TradingWidget::onOrderTypeChanged()
 {
     bool isLimitOrder = limitOrderRadio->isChecked();
     priceSpinBox->setEnabled(isLimitOrder);
+    timeInForceCombo->setEnabled(isLimitOrder);
     
     if (!isLimitOrder) {
         priceSpinBox->setValue(0.0);
@@ -411,8 +446,18 @@ void TradingWidget::executeOrder(bool isBuy)
     
     OrderBookType type = isBuy ? OrderBookType::bid : OrderBookType::ask;
     
-    // For now, just show a success message since we don't have the full trading engine
-    QMessageBox::information(this, "Order Placed", "Your order has been placed successfully!");
+    if (currentTime.empty()) {
+        QMessageBox::warning(this, "Error", "Market data is not loaded yet.");
+        return;
+    }
+    
+    // Market orders sweep the book when the current time frame is matched,
+    // the price only prices the form. Limit orders carry their time in force.
+    OrderBookEntry order{price, amount, currentTime, selectedProduct, type, currentUser->getUsername()};
+    order.kind = marketOrderRadio->isChecked() ? OrderKind::market
+                                               : static_cast<OrderKind>(timeInForceCombo->currentData().toInt());
+    OrderId id = orderBook->insertOrder(order);
+    QMessageBox::information(this, "Order Placed", QString("Order #%1 has been placed successfully!").arg(id));
     
     // Clear form
     amountSpinBox->setValue(0.0);
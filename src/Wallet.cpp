@@ -27,12 +27,13 @@ void Wallet::insertCurrency(std::string type, double amount)
 }
 
 /**Check if the wallet contain this much currency or more**/
-bool Wallet::containsCurrency(std::string type, double amount)
+bool Wallet::containsCurrency(std::string type, double amount) const
 {
-    if(currencies.count(type) == 0) //count is counting elements with a specific key
+    auto it = currencies.find(type);
+    if(it == currencies.end()) //no such currency in the wallet
         return false;
     else 
-        return currencies[type] >= amount; //return the actual value in the wallet
+        return it->second >= amount; //return the actual value in the wallet
 }
 
 std::string Wallet::toString() const
@@ -74,10 +75,10 @@ bool Wallet::removeCurrency(std::string type, double amount)
     }
 }
 
-bool Wallet::canFulfillOrder(OrderBookEntry order)
+bool Wallet::canFulfillOrder(OrderBookEntry order) const
 {
     // currs represent current currency, representation = currs [BTC/ETH/...]
-    std::vector<std::string> currs = CSVReader::tokenise(order.product, '/');
+    std::vector<std::string> currs = CSVReader::tokenise(order.getProduct(), '/');
     //ask
     if(order.orderType == OrderBookType::ask)
     {
@@ -104,7 +105,7 @@ bool Wallet::canFulfillOrder(OrderBookEntry order)
 
 void Wallet::processSale(OrderBookEntry& sale)
 {
-    std::vector<std::string> currs = CSVReader::tokenise(sale.product, '/');
+    std::vector<std::string> currs = CSVReader::tokenise(sale.getProduct(), '/');
     // ask
     if (sale.orderType == OrderBookType::asksale)
     {
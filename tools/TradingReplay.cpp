@@ -0,0 +1,98 @@
+// Headless replay of an order book dataset, for long runs on machines
+// without a display.
+//
+//   TradingReplay <dataset.csv|dataset.obsnap|directory> [speed] [workers] [checkpoints] [every]
+//
+// A directory is replayed day file by day file, see DatasetCatalogue.
+// speed 0 (the default) replays as fast as possible, otherwise it is the
+// number of market seconds replayed per wall-clock second. With a
+// checkpoint log the replay resumes from its latest checkpoint and appends
+// a new one every `every` ticks (default 100).
+#include "CheckpointLog.h"
+#include "DatasetCatalogue.h"
+#include "OrderBook.h"
+#include "ReplayEngine.h"
+#include "Wallet.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: " << argv[0] << " <dataset> [speed] [workers] [checkpoints] [every]" << std::endl;
+        return 1;
+    }
+    double speed = 0;
+    unsigned workers = 0;
+    std::size_t every = 100;
+    try
+    {
+        if (argc > 2) speed = std::stod(argv[2]);
+        if (argc > 3) workers = static_cast<unsigned>(std::stoul(argv[3]));
+        if (argc > 5) every = std::stoul(argv[5]);
+    }
+    catch (const std::exception&)
+    {
+        std::cout << "TradingReplay - bad speed, workers or every argument" << std::endl;
+        return 1;
+    }
+
+    auto loadStart = std::chrono::steady_clock::now();
+    OrderBook book;
+    Wallet wallet;
+    ReplayEngine replay{book, wallet, workers};
+    std::unique_ptr<DatasetCatalogue> days;
+    if (std::filesystem::is_directory(argv[1]))
+    {
+        days = std::make_unique<DatasetCatalogue>(argv[1]);
+        std::cout << "TradingReplay - " << days->getDays().size() << " day files in " << argv[1] << std::endl;
+        replay.setDatasets(days.get());
+    }
+    else
+    {
+        book.loadDataset(argv[1]);
+        replay.rewind();
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    if (book.getTimeline().empty())
+    {
+        std::cout << "TradingReplay - no orders in " << argv[1] << std::endl;
+        return 1;
+    }
+    std::cout << "TradingReplay - loaded " << book.getTimeline().size() << " ticks, "
+              << book.getKnownProducts().size() << " products in " << loadSeconds << "s" << std::endl;
+
+    std::unique_ptr<CheckpointLog> checkpoints;
+    if (argc > 4)
+    {
+        checkpoints = std::make_unique<CheckpointLog>(argv[4]);
+        if (!checkpoints->isOpen())
+        {
+            std::cout << "TradingReplay - " << argv[4] << " is not a checkpoint log" << std::endl;
+            return 1;
+        }
+        if (checkpoints->size() > 0 && checkpoints->restore(checkpoints->size() - 1, replay))
+        {
+            std::cout << "TradingReplay - resumed at " << (replay.finished() ? std::string{"the end"}
+                                                                              : replay.getCurrentTime())
+                      << std::endl;
+        }
+        replay.setCheckpoints(checkpoints.get(), every);
+    }
+    auto runStart = std::chrono::steady_clock::now();
+    replay.run(speed);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    const ReplayEngine::Stats& stats = replay.getStats();
+    std::cout << "TradingReplay - " << stats.ticks << " ticks, " << stats.orders << " orders, "
+              << stats.fills << " fills in " << wallSeconds << "s ("
+              << stats.seconds << "s matching)" << std::endl;
+    std::cout << "  ticks/s  " << stats.ticksPerSecond() << std::endl;
+    std::cout << "  orders/s " << stats.ordersPerSecond() << std::endl;
+    std::cout << "  fills/s  " << stats.fillsPerSecond() << std::endl;
+    return 0;
+}
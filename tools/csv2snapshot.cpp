@@ -0,0 +1,28 @@
+// One-shot conversion of a csv order book dataset into the binary
+// snapshot format read by OrderBook.
+//
+//   csv2snapshot <input.csv> [output.obsnap]
+#include "OrderBookSnapshot.h"
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: " << argv[0] << " <input.csv> [output.obsnap]" << std::endl;
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argc > 2 ? argv[2] : input.substr(0, input.rfind('.')) + ".obsnap";
+
+    if (!OrderBookSnapshot::convertCSV(input, output))
+    {
+        std::cout << "csv2snapshot - conversion of " << input << " failed" << std::endl;
+        return 1;
+    }
+    OrderBookSnapshot snapshot{output};
+    std::cout << "csv2snapshot - wrote " << snapshot.size() << " rows, "
+              << snapshot.products().size() << " products to " << output << std::endl;
+    return 0;
+}